@@ -0,0 +1,1138 @@
+// Benchmark suite comparing every collector in the repository in one binary. Each program's
+// collectors live in a header of their own namespace, shared with the program's demo, over the
+// block heap, marker and reference counting engine of GCCore.h, and every case runs over graphs
+// from GraphGen.h of several shapes and sizes. Results are written as Google Benchmark style JSON with ns per
+// object, edges per second, peak RSS and pause percentiles per case, so runs can be diffed to
+// catch regressions.
+//
+//   g++ -O2 -pthread GCBench.cpp -o gcbench
+//   ./gcbench [--quick] [--reps=N] [--filter=substring] [--huge[=edges]] [--out=results.json]
+//
+// --huge adds a marking run over a random graph of 100M edges, CSR against linked lists, which
+// needs over 4 GB of memory.
+// Built with -DGC_STATS, each case also reports the collectors' time per phase
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "Trace.h"
+#include "GraphGen.h"
+#include "GCStats.h"
+#include "GCReport.h"
+
+// The copying heap must hold the largest generated graph
+#define SEMISPACE_SIZE (256 << 20)
+#include "MarkNSweep.h"
+#include "RefrenceCounting.h"
+#include "RefAns.h"
+#include "try1.h"
+#include "try2.h"
+
+#define BENCH_EDGES_PER_VERTEX 4
+#define BENCH_GARBAGE_FRACTION 0.2
+#define BENCH_SHAPE_PARAM 16
+#define BENCH_SEED 42
+#define BENCH_MAX_THREADS 32
+#define BENCH_INCREMENTAL_BUDGET 4096 // marking work units per incremental step
+#define BENCH_ALLOC_RING 64 // live blocks kept by the allocator microbenchmarks
+#define BENCH_CHURN_BLOCKS 10000 // first fit walks every hole of a churned heap, so this stays small
+#define BENCH_CHAIN_DEPTH 1000000 // vertices of the single chain the recursive marker has to descend
+#define BENCH_HUGE_EDGES 100000000L // edges of the --huge marking run, which needs over 4 GB
+#define BENCH_MORTALITY 90 // percent of the high-mortality workload's allocations that die young
+#define BENCH_MORTALITY_VERTICES 100000
+#define BENCH_MORTALITY_ALLOCS 16 // allocations per vertex of the high-mortality workload
+#define BENCH_MAX_RESULTS 1024
+#define BENCH_MAX_COUNTERS 4
+
+// Structure to represent the outcome of one benchmark case
+typedef struct {
+    char name[128];
+    const char* family;
+    const char* shape;
+    int vertices;
+    long edges;
+    int threads;
+    int iterations;
+    double seconds; // total over the iterations
+    long objects; // objects handled by one iteration
+    long peakRssKb;
+    double* pauses; // seconds, one per collection pause observed
+    int numPauses;
+    int pausesCapacity;
+    const char* counterNames[BENCH_MAX_COUNTERS]; // optional per-iteration counters, e.g. objects freed
+    double counters[BENCH_MAX_COUNTERS];
+    int numCounters;
+    GCStats stats; // what the collectors recorded during the case, with -DGC_STATS
+} BenchResult;
+
+static BenchResult results[BENCH_MAX_RESULTS];
+static int numResults = 0;
+static int benchReps = 5;
+static const char* benchFilter = NULL;
+
+static const char* shapeNames[] = {"random", "power-law", "lists", "tree", "clusters", "mix"};
+
+// Function to read the monotonic clock in seconds
+static double bench_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to read a "Name:   value kB" line of /proc/self/status, -1 if it is missing
+static long proc_status_kb(const char* key) {
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file == NULL)
+        return -1;
+    char line[256];
+    long value = -1;
+    size_t keyLength = strlen(key);
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, key, keyLength) == 0 && line[keyLength] == ':') {
+            value = atol(line + keyLength + 1);
+            break;
+        }
+    }
+    fclose(file);
+    return value;
+}
+
+// Function to restart the peak RSS at the current RSS so each case reports its own high-water mark
+static void reset_peak_rss() {
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (file) {
+        fputs("5", file);
+        fclose(file);
+    }
+}
+
+// Function to format the name of a case, "family/shape/vertices[/threads:N]"
+static void bench_name(char* name, size_t size, const char* family, const char* shape, int vertices, int threads) {
+    if (threads > 0)
+        snprintf(name, size, "%s/%s/%d/threads:%d", family, shape, vertices, threads);
+    else
+        snprintf(name, size, "%s/%s/%d", family, shape, vertices);
+}
+
+// Function to check whether the filter selects a case
+static bool bench_selected(const char* family, const char* shape, int vertices, int threads) {
+    char name[128];
+    bench_name(name, sizeof(name), family, shape, vertices, threads);
+    return (benchFilter == NULL || strstr(name, benchFilter) != NULL) && numResults < BENCH_MAX_RESULTS;
+}
+
+// Function to start a case; returns NULL if the filter excludes it
+static BenchResult* bench_begin(const char* family, const char* shape, int vertices, long edges, int threads) {
+    if (!bench_selected(family, shape, vertices, threads))
+        return NULL;
+    char name[128];
+    bench_name(name, sizeof(name), family, shape, vertices, threads);
+    BenchResult* r = &results[numResults++];
+    memset(r, 0, sizeof(BenchResult));
+    strcpy(r->name, name);
+    r->family = family;
+    r->shape = shape;
+    r->vertices = vertices;
+    r->edges = edges;
+    r->threads = threads > 0 ? threads : 1;
+    fprintf(stderr, "%-56s", name);
+    reset_peak_rss();
+    gc_stats_reset();
+    return r;
+}
+
+// Function to record one collection pause
+static void bench_pause(BenchResult* r, double seconds) {
+    if (r->numPauses == r->pausesCapacity) {
+        r->pausesCapacity = r->pausesCapacity ? r->pausesCapacity * 2 : 16;
+        r->pauses = (double*)realloc(r->pauses, r->pausesCapacity * sizeof(double));
+    }
+    r->pauses[r->numPauses++] = seconds;
+}
+
+// Function to set a named counter of a case, the value of the last iteration is kept
+static void bench_counter(BenchResult* r, const char* name, double value) {
+    int c = 0;
+    while (c < r->numCounters && strcmp(r->counterNames[c], name) != 0)
+        c++;
+    if (c == BENCH_MAX_COUNTERS)
+        return;
+    if (c == r->numCounters)
+        r->counterNames[r->numCounters++] = name;
+    r->counters[c] = value;
+}
+
+// Function to finish a case, taking the peak RSS it reached
+static void bench_end(BenchResult* r) {
+    r->stats = gc_stats_snapshot();
+    r->peakRssKb = proc_status_kb("VmHWM");
+    if (r->peakRssKb < 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        r->peakRssKb = usage.ru_maxrss;
+    }
+    double perIteration = r->iterations ? r->seconds / r->iterations : 0.0;
+    fprintf(stderr, " %12.3f ms %10.2f ns/object\n", perIteration * 1e3,
+            r->objects ? perIteration * 1e9 / r->objects : 0.0);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// Function to find the p-th percentile of sorted samples by the nearest-rank method
+static double percentile(const double* sorted, int count, double p) {
+    if (count == 0)
+        return 0.0;
+    int rank = (int)(p / 100.0 * count + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    return sorted[(rank < count ? rank : count) - 1];
+}
+
+// Mark-and-sweep over linked adjacency lists and CSR (MarkNSweep.cpp)
+
+// Function to build the linked adjacency lists of an edge list
+static marknsweep::Graph* build_linked_graph(const EdgeList* edges) {
+    marknsweep::Graph* graph = marknsweep::createGraph(edges->numVertices);
+    for (long e = 0; e < edges->numEdges; e++)
+        marknsweep::addEdge(graph, edges->src[e], edges->dest[e]);
+    return graph;
+}
+
+static void free_linked_graph(marknsweep::Graph* graph) {
+    for (int i = 0; i < graph->numVertices; i++) {
+        marknsweep::Node* current = graph->array[i];
+        while (current) {
+            marknsweep::Node* next = current->next;
+            free(current);
+            current = next;
+        }
+    }
+    free(graph->array);
+    free(graph);
+}
+
+// Structure to pass a recursive mark to a thread with a stack deep enough for it
+typedef struct {
+    marknsweep::Graph* graph;
+    marknsweep::MarkBitmap* marks;
+} RecursiveMark;
+
+static void* recursive_mark_thread(void* arg) {
+    RecursiveMark* job = (RecursiveMark*)arg;
+    marknsweep::DFS(job->graph, 0, job->marks);
+    return NULL;
+}
+
+// Function to time the recursive, iterative and incremental markers over linked lists
+static void bench_linked_marking(const EdgeList* edges, const char* shape) {
+    marknsweep::Graph* graph = NULL;
+    marknsweep::MarkBitmap* marks = marknsweep::createMarkBitmap(edges->numVertices);
+
+    BenchResult* r = bench_begin("marksweep.recursive", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        graph = build_linked_graph(edges);
+        // A recursion per live vertex in the worst case, so the thread gets a stack to match
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, (size_t)edges->numVertices * 256 + (1 << 20));
+        RecursiveMark job = {graph, marks};
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::clearMarkBitmap(marks);
+            pthread_t thread;
+            double start = bench_now();
+            pthread_create(&thread, &attr, recursive_mark_thread, &job);
+            pthread_join(thread, NULL);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        pthread_attr_destroy(&attr);
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    r = bench_begin("marksweep.iterative", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        if (graph == NULL)
+            graph = build_linked_graph(edges);
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::clearMarkBitmap(marks);
+            double start = bench_now();
+            marknsweep::DFS_iterative(graph, 0, marks);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    r = bench_begin("marksweep.incremental", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        if (graph == NULL)
+            graph = build_linked_graph(edges);
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::IncrementalMarker* m = marknsweep::incremental_mark_begin(graph, 0);
+            bool done = false;
+            while (!done) {
+                double start = bench_now();
+                done = marknsweep::incremental_mark_step(m, BENCH_INCREMENTAL_BUDGET);
+                double seconds = bench_now() - start;
+                r->seconds += seconds;
+                bench_pause(r, seconds);
+            }
+            marknsweep::freeIncrementalMarker(m);
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    if (graph)
+        free_linked_graph(graph);
+    marknsweep::freeMarkBitmap(marks);
+}
+
+// Function to time the sequential and the work-stealing parallel marker over CSR
+static void bench_csr_marking(const EdgeList* edges, const char* shape) {
+    marknsweep::CSRGraph* csr = marknsweep::createCSRGraph(edges->numVertices, edges->src, edges->dest,
+                                                           (int)edges->numEdges);
+    marknsweep::MarkBitmap* marks = marknsweep::createMarkBitmap(edges->numVertices);
+
+    BenchResult* r = bench_begin("marksweep.csr", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::clearMarkBitmap(marks);
+            double start = bench_now();
+            marknsweep::DFS_csr(csr, 0, marks);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    int root = 0;
+    for (int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+        r = bench_begin("marksweep.parallel", shape, edges->numVertices, edges->numEdges, threads);
+        if (r == NULL)
+            continue;
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::clearMarkBitmap(marks);
+            double start = bench_now();
+            marknsweep::parallel_mark_csr(csr, &root, 1, threads, marks->words);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    marknsweep::freeMarkBitmap(marks);
+    marknsweep::freeCSRGraph(csr);
+}
+
+// Function to make the edge list of a single chain 0 -> 1 -> ... -> 'depth' - 1, the deepest
+// graph a marker can be given
+static EdgeList* generate_chain(int depth) {
+    EdgeList* edges = (EdgeList*)malloc(sizeof(EdgeList));
+    edges->numVertices = depth;
+    edges->numLive = depth;
+    edges->numEdges = depth - 1;
+    edges->src = (int*)malloc(edges->numEdges * sizeof(int));
+    edges->dest = (int*)malloc(edges->numEdges * sizeof(int));
+    for (long e = 0; e < edges->numEdges; e++) {
+        edges->src[e] = (int)e;
+        edges->dest[e] = (int)e + 1;
+    }
+    return edges;
+}
+
+// Function to time marking a random graph of 'numEdges' edges over CSR and over linked lists,
+// with only the sequential markers so the linked form fits beside the edge list. The CSR is
+// dropped before the linked lists are built and the edge list once they are
+static void bench_huge_marking(long numEdges) {
+    int vertices = (int)(numEdges / BENCH_EDGES_PER_VERTEX);
+    int numThreads = (int)std::thread::hardware_concurrency();
+    GenSpec spec = {GEN_RANDOM, vertices, numEdges, BENCH_GARBAGE_FRACTION, BENCH_SHAPE_PARAM, BENCH_SEED,
+                    numThreads > 0 ? numThreads : 1};
+    EdgeList* edges = generate_edges(&spec);
+    numEdges = edges->numEdges;
+    marknsweep::MarkBitmap* marks = marknsweep::createMarkBitmap(vertices);
+
+    BenchResult* r = bench_begin("marksweep.csr", "random", vertices, numEdges, 0);
+    if (r) {
+        marknsweep::CSRGraph* csr = marknsweep::createCSRGraph(vertices, edges->src, edges->dest, (int)numEdges);
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::clearMarkBitmap(marks);
+            double start = bench_now();
+            marknsweep::DFS_csr(csr, 0, marks);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        marknsweep::freeCSRGraph(csr);
+        r->objects = vertices;
+        bench_end(r);
+    }
+
+    r = bench_begin("marksweep.iterative", "random", vertices, numEdges, 0);
+    if (r) {
+        marknsweep::Graph* graph = build_linked_graph(edges);
+        free_edges(edges);
+        edges = NULL;
+        for (int rep = 0; rep < benchReps; rep++) {
+            marknsweep::clearMarkBitmap(marks);
+            double start = bench_now();
+            marknsweep::DFS_iterative(graph, 0, marks);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        free_linked_graph(graph);
+        r->objects = vertices;
+        bench_end(r);
+    }
+
+    if (edges)
+        free_edges(edges);
+    marknsweep::freeMarkBitmap(marks);
+}
+
+// Reference counting (RefrenceCounting.cpp and the block heap of try1.cpp)
+
+// Function to time counting every reference from scratch, over linked lists and over CSR
+static void bench_reference_counts(const EdgeList* edges, const char* shape) {
+    if (!bench_selected("refcount.count.linked", shape, edges->numVertices, 0) &&
+        !bench_selected("refcount.count.csr", shape, edges->numVertices, 0))
+        return;
+    refcount::Graph* graph = refcount::createGraph(edges->numVertices);
+    for (long e = 0; e < edges->numEdges; e++)
+        refcount::addEdge(graph, edges->src[e], edges->dest[e]);
+    refcount::CSRGraph* csr = refcount::graph_to_csr(graph);
+    refcount::Heap heap;
+    refcount::initialize_heap(&heap, graph);
+
+    BenchResult* r = bench_begin("refcount.count.linked", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        for (int rep = 0; rep < benchReps; rep++) {
+            memset(heap.reference_counts, 0, edges->numVertices * sizeof(int));
+            double start = bench_now();
+            refcount::mark_references(&heap);
+            r->seconds += bench_now() - start;
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    r = bench_begin("refcount.count.csr", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        for (int rep = 0; rep < benchReps; rep++) {
+            double start = bench_now();
+            refcount::mark_references_csr(&heap, csr);
+            r->seconds += bench_now() - start;
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    refcount::freeCSRGraph(csr);
+    refcount::free_heap(&heap);
+}
+
+// Function to drop every chunk of the shared block heap before a try1 run
+static void reset_blockrc_heap() {
+    gccore::reset_heap();
+}
+
+// Function to time counted stores building the graph from its root, then the release of the
+// root: the acyclic part is freed by the cascade and the cycles by the cycle collector
+static void bench_rc_lifecycle(const EdgeList* edges, const char* shape) {
+    bool releasing = bench_selected("refcount.release", shape, edges->numVertices, 0);
+    BenchResult* build = bench_begin("refcount.build", shape, edges->numVertices, edges->numEdges, 0);
+    BenchResult* release = NULL;
+    if (build == NULL && !releasing)
+        return;
+    for (int rep = 0; rep < benchReps; rep++) {
+        reset_blockrc_heap();
+        blockrc::set_alloc_mode(blockrc::ALLOC_SEGREGATED);
+        blockrc::Graph* graph = blockrc::createGraph(edges->numVertices);
+        blockrc::Heap heap;
+        blockrc::initialize_heap(&heap, graph, true);
+        double start = bench_now();
+        blockrc::set_root(&heap, 0);
+        for (long e = 0; e < edges->numEdges; e++)
+            blockrc::add_ref(&heap, edges->src[e], edges->dest[e]);
+        if (build) {
+            build->seconds += bench_now() - start;
+            build->iterations++;
+        }
+
+        // The release case reuses each built graph, so it starts once the first build is measured
+        if (rep == 0) {
+            if (build) {
+                build->objects = edges->numEdges;
+                bench_end(build);
+            }
+            if (releasing)
+                release = bench_begin("refcount.release", shape, edges->numVertices, edges->numEdges, 0);
+        }
+        if (release) {
+            start = bench_now();
+            blockrc::clear_root(&heap, 0);
+            int freed = blockrc::collect_cycles(&heap);
+            double seconds = bench_now() - start;
+            release->seconds += seconds;
+            bench_pause(release, seconds);
+            release->iterations++;
+            bench_counter(release, "cycle_objects_freed", freed);
+        }
+        free(graph->array);
+        free(heap.reference_counts);
+        free(heap.is_root);
+        free(heap.freed);
+        free(heap.color);
+        free(heap.buffered);
+        free(heap.cycle_roots);
+        free(heap.in_zct);
+        free(heap.zct);
+    }
+    if (release) {
+        release->objects = edges->numVertices;
+        bench_end(release);
+    }
+}
+
+// Function to replay the graph as a heap trace with every root update counted and with root
+// updates deferred, comparing the reference count traffic of the two on the same events
+static void bench_rc_trace(const EdgeList* edges, const char* shape) {
+    const char* families[] = {"refcount.trace", "refcount.trace_deferred"};
+    const char* modes[] = {"rc", "deferred"};
+    if (!bench_selected(families[0], shape, edges->numVertices, 0) &&
+        !bench_selected(families[1], shape, edges->numVertices, 0))
+        return;
+    char path[] = "/tmp/gcbench-trace-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return;
+    close(fd);
+    TraceMap trace;
+    if (write_edges_trace(edges, sizeof(blockrc::Node), path) != 0 || trace_map(path, &trace) != 0) {
+        unlink(path);
+        return;
+    }
+    for (int m = 0; m < 2; m++) {
+        BenchResult* r = bench_begin(families[m], shape, edges->numVertices, edges->numEdges, 0);
+        if (r == NULL)
+            continue;
+        for (int rep = 0; rep < benchReps; rep++) {
+            reset_blockrc_heap();
+            blockrc::ReplayResult result;
+            if (blockrc::replay_events(&trace, modes[m], &result) != 0)
+                break;
+            r->seconds += result.seconds;
+            r->iterations++;
+            bench_counter(r, "count_updates", result.count_updates);
+            bench_counter(r, "root_updates_skipped", result.skipped_updates);
+        }
+        r->objects = (long)trace.header->num_events;
+        bench_end(r);
+    }
+    trace_unmap(&trace);
+    unlink(path);
+}
+
+// Collectors of the try2.cpp block heap
+
+// Function to drop every chunk of the shared block heap and the lazy sweep state before a try2 run
+static void reset_blockms_heap() {
+    blockms::lazy_cursor = -1;
+    blockms::lazy_graph = NULL;
+    gccore::reset_heap();
+}
+
+// Function to build an edge list in the block heap with the given allocation policy
+static blockms::Graph* build_blockms_graph(const EdgeList* edges, int mode) {
+    reset_blockms_heap();
+    blockms::set_alloc_mode(mode);
+    blockms::Graph* graph = blockms::createGraph(edges->numVertices);
+    for (long e = 0; e < edges->numEdges; e++)
+        blockms::addEdge(graph, edges->src[e], edges->dest[e]);
+    return graph;
+}
+
+// Function to time mark-and-sweep with an eager and with a lazy sweep (where the pause is only
+// the mark), and mark-compact, all from the generated root
+static void bench_block_heap(const EdgeList* edges, const char* shape) {
+    int root = 0;
+    BenchResult* r = bench_begin("blockheap.mark_sweep", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        int mode = gc_report.mode;
+        gc_report.mode = GC_REPORT_SUMMARY; // one line per garbage node would time stdio
+        for (int rep = 0; rep < benchReps; rep++) {
+            blockms::Graph* graph = build_blockms_graph(edges, blockms::ALLOC_SEGREGATED);
+            double start = bench_now();
+            blockms::mark_and_sweep(graph, &root, 1);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        gc_report.mode = mode;
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    r = bench_begin("blockheap.lazy_sweep", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        for (int rep = 0; rep < benchReps; rep++) {
+            blockms::Graph* graph = build_blockms_graph(edges, blockms::ALLOC_SEGREGATED);
+            long swept = blockms::lazy_swept;
+            double start = bench_now();
+            blockms::mark_and_sweep_lazy(graph, &root, 1);
+            double marked = bench_now();
+            blockms::finish_lazy_sweep();
+            double end = bench_now();
+            r->seconds += end - start;
+            bench_pause(r, marked - start);
+            r->iterations++;
+            bench_counter(r, "objects_freed", blockms::lazy_swept - swept);
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+
+    r = bench_begin("blockheap.mark_compact", shape, edges->numVertices, edges->numEdges, 0);
+    if (r) {
+        for (int rep = 0; rep < benchReps; rep++) {
+            blockms::Graph* graph = build_blockms_graph(edges, blockms::ALLOC_SEGREGATED);
+            double start = bench_now();
+            blockms::mark_compact(&graph, &root, 1, NULL, 0);
+            double seconds = bench_now() - start;
+            r->seconds += seconds;
+            bench_pause(r, seconds);
+            r->iterations++;
+        }
+        r->objects = edges->numVertices;
+        bench_end(r);
+    }
+}
+
+// Function to time Cheney copying of the whole graph out of a semispace
+static void bench_semispace(const EdgeList* edges, const char* shape) {
+    BenchResult* r = bench_begin("copying.semispace", shape, edges->numVertices, edges->numEdges, 0);
+    if (r == NULL)
+        return;
+    if (blockms::from_space == NULL)
+        blockms::init_semispace();
+    static int root = 0;
+    for (int rep = 0; rep < benchReps; rep++) {
+        reset_blockms_heap();
+        blockms::space_top = blockms::from_space;
+        blockms::set_alloc_mode(blockms::ALLOC_SEMISPACE);
+        blockms::Graph* graph = blockms::createGraph(edges->numVertices);
+        blockms::semispace_set_roots(graph, &root, 1);
+        for (long e = 0; e < edges->numEdges; e++)
+            blockms::addEdge(graph, edges->src[e], edges->dest[e]);
+        double start = bench_now();
+        int reclaimed = blockms::semispace_collect(graph, &root, 1);
+        double seconds = bench_now() - start;
+        r->seconds += seconds;
+        bench_pause(r, seconds);
+        r->iterations++;
+        bench_counter(r, "lists_reclaimed", reclaimed);
+    }
+    blockms::set_alloc_mode(blockms::ALLOC_FIRST_FIT);
+    r->objects = edges->numVertices;
+    bench_end(r);
+}
+
+// Function to unmap the nursery and free the remembered set of the previous generational run
+static void release_generations() {
+    if (blockms::nursery)
+        munmap(blockms::nursery, NURSERY_SIZE);
+    free(blockms::promoted);
+    free(blockms::old_referenced);
+    free(blockms::remembered);
+    free(blockms::remembered_set);
+    free(blockms::remembered_nodes);
+    blockms::nursery = NULL;
+    blockms::promoted = NULL;
+    blockms::old_referenced = NULL;
+    blockms::remembered = NULL;
+    blockms::remembered_set = NULL;
+    blockms::remembered_nodes = NULL;
+    blockms::remembered_node_capacity = 0;
+}
+
+// Function to time building the graph through the nursery; each minor collection is a pause
+static void bench_generational(const EdgeList* edges, const char* shape) {
+    BenchResult* r = bench_begin("generational.minor", shape, edges->numVertices, edges->numEdges, 0);
+    if (r == NULL)
+        return;
+    static int root = 0;
+    for (int rep = 0; rep < benchReps; rep++) {
+        reset_blockms_heap();
+        release_generations();
+        blockms::set_alloc_mode(blockms::ALLOC_FIRST_FIT);
+        blockms::Graph* graph = blockms::createGraph(edges->numVertices);
+        blockms::init_generations(graph, &root, 1);
+        blockms::set_alloc_mode(blockms::ALLOC_GENERATIONAL);
+        size_t promoted = blockms::promoted_bytes;
+        double start = bench_now();
+        for (long e = 0; e < edges->numEdges; e++) {
+            // Collect here rather than inside nursery_alloc() so every minor pause is timed
+            if (blockms::nursery_top + sizeof(blockms::Node) > blockms::nursery + NURSERY_SIZE) {
+                double pauseStart = bench_now();
+                blockms::minor_collect(graph, &root, 1);
+                bench_pause(r, bench_now() - pauseStart);
+            }
+            blockms::addEdge(graph, edges->src[e], edges->dest[e]);
+        }
+        double pauseStart = bench_now();
+        blockms::minor_collect(graph, &root, 1);
+        double end = bench_now();
+        bench_pause(r, end - pauseStart);
+        r->seconds += end - start;
+        r->iterations++;
+        bench_counter(r, "bytes_promoted", (long)(blockms::promoted_bytes - promoted));
+    }
+    blockms::set_alloc_mode(blockms::ALLOC_FIRST_FIT);
+    release_generations();
+    r->objects = edges->numEdges;
+    bench_end(r);
+}
+
+// Function to time a mutator whose allocations mostly die young under mark-and-sweep, Cheney
+// copying and the nursery. Vertex 0 roots a tenth of the vertices; every allocation is an edge
+// added to one of them with probability 100 - BENCH_MORTALITY percent and otherwise to a vertex
+// nothing reaches. Each collector runs once per nursery's worth of allocations, so ns per object
+// is the cost of one allocation with its share of the collections, and every collection is a pause
+static void bench_high_mortality(int vertices, long ops) {
+    const char* families[] = {"blockheap.mark_sweep", "copying.semispace", "generational.minor"};
+    int modes[] = {blockms::ALLOC_SEGREGATED, blockms::ALLOC_SEMISPACE, blockms::ALLOC_GENERATIONAL};
+    long interval = NURSERY_SIZE / sizeof(blockms::Node);
+    int survivors = vertices / 10;
+    static int root = 0;
+    for (int m = 0; m < 3; m++) {
+        BenchResult* r = bench_begin(families[m], "high-mortality", vertices, ops, 0);
+        if (r == NULL)
+            continue;
+        for (int rep = 0; rep < benchReps; rep++) {
+            reset_blockms_heap();
+            release_generations();
+            if (modes[m] == blockms::ALLOC_SEMISPACE) {
+                if (blockms::from_space == NULL)
+                    blockms::init_semispace();
+                blockms::space_top = blockms::from_space;
+            }
+            // The nursery starts empty, the root's list is old
+            blockms::set_alloc_mode(modes[m] == blockms::ALLOC_GENERATIONAL ? blockms::ALLOC_FIRST_FIT : modes[m]);
+            blockms::Graph* graph = blockms::createGraph(vertices);
+            if (modes[m] == blockms::ALLOC_SEMISPACE)
+                blockms::semispace_set_roots(graph, &root, 1);
+            for (int v = 1; v <= survivors; v++)
+                blockms::addEdge(graph, 0, v);
+            if (modes[m] == blockms::ALLOC_GENERATIONAL) {
+                blockms::init_generations(graph, &root, 1);
+                blockms::set_alloc_mode(blockms::ALLOC_GENERATIONAL);
+            }
+            unsigned state = (unsigned)rep + 1;
+            int collections = 0;
+            double start = bench_now();
+            for (long i = 0; i < ops; i++) {
+                if (i > 0 && i % interval == 0) {
+                    double pauseStart = bench_now();
+                    if (modes[m] == blockms::ALLOC_SEGREGATED)
+                        blockms::mark_and_sweep(graph, &root, 1);
+                    else if (modes[m] == blockms::ALLOC_SEMISPACE)
+                        blockms::semispace_collect(graph, &root, 1);
+                    else
+                        blockms::minor_collect(graph, &root, 1);
+                    bench_pause(r, bench_now() - pauseStart);
+                    collections++;
+                }
+                // Survivors point only at survivors, so nothing reachable points at the garbage
+                if ((int)(rand_r(&state) % 100) < BENCH_MORTALITY)
+                    blockms::addEdge(graph, survivors + 1 + rand_r(&state) % (vertices - survivors - 1),
+                                     rand_r(&state) % vertices);
+                else
+                    blockms::addEdge(graph, 1 + rand_r(&state) % survivors, 1 + rand_r(&state) % survivors);
+            }
+            r->seconds += bench_now() - start;
+            r->iterations++;
+            bench_counter(r, "collections", collections);
+        }
+        blockms::set_alloc_mode(blockms::ALLOC_FIRST_FIT);
+        release_generations();
+        r->objects = ops;
+        bench_end(r);
+    }
+}
+
+// Typed objects of RefAns.cpp, collected by reference counting from several roots
+
+// Function to lay out a chain of 'depth' diamonds from slot 'base': every top is a pair whose two
+// boxes both point at the next top, so the number of paths doubles at each level, and the chain
+// ends in a leaf. Takes 3 * depth + 1 slots
+static void build_refans_diamond(int base, int depth) {
+    for (int k = 0; k < depth; k++) {
+        refans::array[base + 3 * k] = refans::new_object(refans::TYPE_PAIR, base + 3 * k, base + 3 * k);
+        refans::array[base + 3 * k + 1] = refans::new_object(refans::TYPE_BOX, base + 3 * k + 1, base + 3 * k + 1);
+        refans::array[base + 3 * k + 2] = refans::new_object(refans::TYPE_BOX, base + 3 * k + 2, base + 3 * k + 2);
+    }
+    refans::array[base + 3 * depth] = refans::new_object(refans::TYPE_LEAF, base + 3 * depth, base + 3 * depth);
+    for (int k = 0; k < depth; k++) {
+        refans::set_field(base + 3 * k, 0, base + 3 * k + 1);
+        refans::set_field(base + 3 * k, 1, base + 3 * k + 2);
+        refans::set_field(base + 3 * k + 1, 0, base + 3 * k + 3);
+        refans::set_field(base + 3 * k + 2, 0, base + 3 * k + 3);
+    }
+}
+
+// Function to build two diamond chains of 'depth' levels, the first held by a root on its top and
+// one on its middle top, the second unreachable; fills roots[2]
+static void build_refans_heap(int depth, refans::Node** roots) {
+    refans::init_objects(2 * (3 * depth + 1));
+    build_refans_diamond(0, depth);
+    build_refans_diamond(3 * depth + 1, depth);
+    roots[0] = refans::array[0];
+    roots[1] = refans::array[3 * (depth / 2)];
+    roots[0]->referenceCount += 1;
+    roots[1]->referenceCount += 1;
+}
+
+// Function to tell whether 'target' can be reached from 'from', following every path as the
+// per-object check RefAns.cpp used before the live set was marked once per collection
+static bool refans_path_to(refans::Node* from, refans::Node* target) {
+    if (from == NULL)
+        return false;
+    if (from == target)
+        return true;
+    for (int k = 0; k < refans::num_fields(from); k++) {
+        if (refans_path_to(*refans::field_slot(from, k), target))
+            return true;
+    }
+    return false;
+}
+
+// Function to time reference_counting() marking the live set once from both roots of a diamond
+// heap of 'vertices' objects, half of them garbage
+static void bench_refans_diamond(int vertices) {
+    int depth = (vertices / 2 - 1) / 3;
+    BenchResult* r = bench_begin("refans.reference_counting", "diamond", 2 * (3 * depth + 1), 0, 0);
+    if (r == NULL)
+        return;
+    int mode = gc_report.mode;
+    gc_report.mode = GC_REPORT_SUMMARY; // one line per garbage object would time stdio
+    for (int rep = 0; rep < benchReps; rep++) {
+        refans::Node* roots[2];
+        build_refans_heap(depth, roots);
+        double start = bench_now();
+        refans::reference_counting(roots, 2);
+        double seconds = bench_now() - start;
+        r->seconds += seconds;
+        r->iterations++;
+        bench_pause(r, seconds);
+    }
+    gc_report.mode = mode;
+    r->objects = refans::num_objects;
+    r->edges = 8L * depth;
+    refans::init_objects(0);
+    bench_end(r);
+}
+
+// Function to compare reference_counting() with searching every path from the roots once per
+// object, which doubles with every level of a diamond chain, so only shallow chains are timed
+static void bench_refans_per_object() {
+    int depths[] = {8, 12, 16};
+    for (int d = 0; d < 3; d++) {
+        int vertices = 2 * (3 * depths[d] + 1);
+        BenchResult* r = bench_begin("refans.per_object_walk", "diamond", vertices, 0, 0);
+        if (r != NULL) {
+            refans::Node* roots[2];
+            build_refans_heap(depths[d], roots);
+            int garbage = 0;
+            for (int rep = 0; rep < benchReps; rep++) {
+                double start = bench_now();
+                garbage = 0;
+                for (int i = 0; i < refans::num_objects; i++) {
+                    if (!refans_path_to(roots[0], refans::array[i]) && !refans_path_to(roots[1], refans::array[i]))
+                        garbage++;
+                }
+                r->seconds += bench_now() - start;
+                r->iterations++;
+            }
+            bench_counter(r, "garbage", garbage);
+            r->objects = vertices;
+            r->edges = 8L * depths[d];
+            refans::init_objects(0);
+            bench_end(r);
+        }
+        bench_refans_diamond(vertices);
+    }
+}
+
+// Allocators, independent of the graph shape
+
+// Function to time replacing blocks of a live ring one at a time with first fit or size classes
+static void bench_block_alloc(long ops, int vertices) {
+    const char* families[] = {"alloc.first_fit", "alloc.segregated"};
+    int modes[] = {blockms::ALLOC_FIRST_FIT, blockms::ALLOC_SEGREGATED};
+    for (int m = 0; m < 2; m++) {
+        BenchResult* r = bench_begin(families[m], "ring", vertices, 0, 0);
+        if (r == NULL)
+            continue;
+        for (int rep = 0; rep < benchReps; rep++) {
+            reset_blockms_heap();
+            blockms::set_alloc_mode(modes[m]);
+            void* live[BENCH_ALLOC_RING] = {NULL};
+            unsigned state = (unsigned)rep + 1;
+            double start = bench_now();
+            for (long i = 0; i < ops; i++) {
+                int slot = (int)(i % BENCH_ALLOC_RING);
+                blockms::free_mem(live[slot]);
+                live[slot] = blockms::alloc((size_t)MIN_CLASS_SIZE << (rand_r(&state) % NUM_SIZE_CLASSES));
+            }
+            r->seconds += bench_now() - start;
+            r->iterations++;
+        }
+        blockms::set_alloc_mode(blockms::ALLOC_FIRST_FIT);
+        r->objects = ops;
+        bench_end(r);
+    }
+}
+
+// Function to measure the fragmentation first fit and size classes leave behind after a churn:
+// 'vertices' blocks of mixed sizes, every other one of them freed at random, then half as many
+// again of larger sizes, so class blocks have to give memory back for the second wave to reuse
+static void bench_alloc_fragmentation(int vertices) {
+    const char* families[] = {"alloc.first_fit", "alloc.segregated"};
+    int modes[] = {blockms::ALLOC_FIRST_FIT, blockms::ALLOC_SEGREGATED};
+    void** live = (void**)malloc((size_t)vertices * 2 * sizeof(void*));
+    for (int m = 0; m < 2; m++) {
+        BenchResult* r = bench_begin(families[m], "churn", vertices, 0, 0);
+        if (r == NULL)
+            continue;
+        long ops = 0;
+        for (int rep = 0; rep < benchReps; rep++) {
+            reset_blockms_heap();
+            blockms::set_alloc_mode(modes[m]);
+            unsigned state = (unsigned)rep + 1;
+            int count = 0;
+            size_t liveBytes = 0;
+            double start = bench_now();
+            for (int i = 0; i < vertices; i++)
+                live[count++] = blockms::alloc(8 + rand_r(&state) % 505);
+            for (int i = 0; i < count; i++) {
+                if (rand_r(&state) % 2) {
+                    blockms::free_mem(live[i]);
+                    live[i] = NULL;
+                }
+            }
+            for (int i = 0; i < vertices / 2; i++)
+                live[count++] = blockms::alloc(256 + rand_r(&state) % 769);
+            r->seconds += bench_now() - start;
+            r->iterations++;
+            ops = vertices + vertices / 2;
+
+            size_t heapBytes = 0;
+            for (blockms::Chunk* chunk = blockms::chunk_list; chunk; chunk = chunk->next)
+                heapBytes += chunk->size;
+            for (int i = 0; i < count; i++) {
+                if (live[i])
+                    liveBytes += ((blockms::Block*)live[i] - 1)->size;
+            }
+            bench_counter(r, "fragmentation", blockms::heap_fragmentation());
+            bench_counter(r, "heap_kb", (double)(heapBytes >> 10));
+            bench_counter(r, "live_kb", (double)(liveBytes >> 10));
+            bench_counter(r, "free_blocks", (double)blockms::free_block_count());
+        }
+        blockms::set_alloc_mode(blockms::ALLOC_FIRST_FIT);
+        r->objects = ops;
+        bench_end(r);
+    }
+    free(live);
+}
+
+// Function to time the thread-caching allocator of try1.cpp as threads are added
+static void bench_alloc_mt(long ops, int vertices) {
+    for (int threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+        BenchResult* r = bench_begin("alloc.thread_cache", "ring", vertices, 0, threads);
+        if (r == NULL)
+            continue;
+        int perThread = (int)(ops / threads);
+        for (int rep = 0; rep < benchReps; rep++) {
+            reset_blockrc_heap();
+            double rate = blockrc::alloc_mt_benchmark(threads, perThread);
+            r->seconds += rate > 0 ? (double)threads * perThread / rate : 0.0;
+            r->iterations++;
+        }
+        r->objects = (long)threads * perThread;
+        bench_end(r);
+    }
+}
+
+// Function to write one string as a JSON string literal
+static void json_string(FILE* out, const char* s) {
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fputc('\\', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+// Function to write every result in the layout of Google Benchmark's JSON reporter
+static void write_json(FILE* out, const char* executable) {
+    char host[256] = "unknown", date[64];
+    gethostname(host, sizeof(host) - 1);
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", localtime(&now));
+    fprintf(out, "{\n  \"context\": {\n    \"date\": ");
+    json_string(out, date);
+    fprintf(out, ",\n    \"host_name\": ");
+    json_string(out, host);
+    fprintf(out, ",\n    \"executable\": ");
+    json_string(out, executable);
+    fprintf(out, ",\n    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+#ifdef __OPTIMIZE__
+    fprintf(out, "    \"library_build_type\": \"release\",\n");
+#else
+    fprintf(out, "    \"library_build_type\": \"debug\",\n");
+#endif
+    fprintf(out, "    \"repetitions\": %d,\n    \"seed\": %d\n  },\n  \"benchmarks\": [", benchReps, BENCH_SEED);
+    for (int i = 0; i < numResults; i++) {
+        BenchResult* r = &results[i];
+        double perIteration = r->iterations ? r->seconds / r->iterations : 0.0;
+        qsort(r->pauses, r->numPauses, sizeof(double), compare_doubles);
+        fprintf(out, "%s\n    {\n      \"name\": ", i ? "," : "");
+        json_string(out, r->name);
+        fprintf(out, ",\n      \"family\": ");
+        json_string(out, r->family);
+        fprintf(out, ",\n      \"shape\": ");
+        json_string(out, r->shape);
+        fprintf(out, ",\n      \"vertices\": %d,\n      \"edges\": %ld,\n      \"threads\": %d,\n",
+                r->vertices, r->edges, r->threads);
+        fprintf(out, "      \"iterations\": %d,\n      \"real_time\": %.1f,\n      \"time_unit\": \"ns\",\n",
+                r->iterations, perIteration * 1e9);
+        fprintf(out, "      \"objects\": %ld,\n      \"ns_per_object\": %.3f,\n", r->objects,
+                r->objects ? perIteration * 1e9 / r->objects : 0.0);
+        fprintf(out, "      \"edges_per_second\": %.0f,\n      \"peak_rss_kb\": %ld,\n",
+                perIteration > 0 ? r->edges / perIteration : 0.0, r->peakRssKb);
+        fprintf(out, "      \"pauses\": %d,\n      \"pause_p50_us\": %.2f,\n      \"pause_p90_us\": %.2f,\n",
+                r->numPauses, percentile(r->pauses, r->numPauses, 50) * 1e6,
+                percentile(r->pauses, r->numPauses, 90) * 1e6);
+        fprintf(out, "      \"pause_p99_us\": %.2f,\n      \"pause_max_us\": %.2f",
+                percentile(r->pauses, r->numPauses, 99) * 1e6,
+                r->numPauses ? r->pauses[r->numPauses - 1] * 1e6 : 0.0);
+        for (int c = 0; c < r->numCounters; c++)
+            fprintf(out, ",\n      \"%s\": %.10g", r->counterNames[c], r->counters[c]);
+#ifdef GC_STATS
+        if (r->stats.collections) {
+            for (int p = 0; p < GC_NUM_PHASES; p++)
+                fprintf(out, ",\n      \"%s_ns\": %.1f", gc_phase_names[p],
+                        r->iterations ? r->stats.phase_seconds[p] * 1e9 / r->iterations : 0.0);
+            fprintf(out, ",\n      \"mark_stack_high_water\": %ld", r->stats.mark_stack_high_water);
+        }
+#endif
+        fprintf(out, "\n    }");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = NULL;
+    bool quick = false;
+    long hugeEdges = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0)
+            quick = true;
+        else if (strncmp(argv[i], "--reps=", 7) == 0)
+            benchReps = atoi(argv[i] + 7) > 0 ? atoi(argv[i] + 7) : 1;
+        else if (strncmp(argv[i], "--filter=", 9) == 0)
+            benchFilter = argv[i] + 9;
+        else if (strncmp(argv[i], "--out=", 6) == 0)
+            outPath = argv[i] + 6;
+        else if (strcmp(argv[i], "--huge") == 0)
+            hugeEdges = BENCH_HUGE_EDGES;
+        else if (strncmp(argv[i], "--huge=", 7) == 0)
+            hugeEdges = atol(argv[i] + 7);
+        else {
+            fprintf(stderr, "Usage: %s [--quick] [--reps=N] [--filter=substring] [--huge[=edges]] [--out=file.json]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    int sizes[] = {10000, 100000, 1000000};
+    int numSizes = quick ? 1 : 3;
+    int numThreads = (int)std::thread::hardware_concurrency();
+    blockrc::init_heap();
+    blockms::init_heap();
+    // Per-object messages would time stdio instead of the collectors
+    blockrc::quiet = 1;
+    blockms::quiet = 1;
+
+    for (int s = 0; s < numSizes; s++) {
+        for (int shape = GEN_RANDOM; shape <= GEN_MIX; shape++) {
+            GenSpec spec = {shape, sizes[s], (long)sizes[s] * BENCH_EDGES_PER_VERTEX, BENCH_GARBAGE_FRACTION,
+                            BENCH_SHAPE_PARAM, BENCH_SEED, numThreads > 0 ? numThreads : 1};
+            EdgeList* edges = generate_edges(&spec);
+            bench_linked_marking(edges, shapeNames[shape]);
+            bench_csr_marking(edges, shapeNames[shape]);
+            bench_block_heap(edges, shapeNames[shape]);
+            bench_semispace(edges, shapeNames[shape]);
+            bench_generational(edges, shapeNames[shape]);
+            bench_reference_counts(edges, shapeNames[shape]);
+            bench_rc_lifecycle(edges, shapeNames[shape]);
+            bench_rc_trace(edges, shapeNames[shape]);
+            free_edges(edges);
+        }
+        long ops = (long)sizes[s] * BENCH_EDGES_PER_VERTEX;
+        bench_block_alloc(ops, sizes[s]);
+        bench_alloc_mt(ops, sizes[s]);
+        bench_refans_diamond(sizes[s]);
+    }
+    EdgeList* chain = generate_chain(BENCH_CHAIN_DEPTH);
+    bench_linked_marking(chain, "chain");
+    free_edges(chain);
+    bench_high_mortality(BENCH_MORTALITY_VERTICES, (long)BENCH_MORTALITY_VERTICES * BENCH_MORTALITY_ALLOCS);
+    bench_refans_per_object();
+    bench_alloc_fragmentation(BENCH_CHURN_BLOCKS);
+    if (hugeEdges > 0)
+        bench_huge_marking(hugeEdges);
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (out == NULL) {
+        fprintf(stderr, "Error: Unable to write %s\n", outPath);
+        return 1;
+    }
+    write_json(out, argv[0]);
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
@@ -0,0 +1,1207 @@
+#ifndef GCCORE_H
+#define GCCORE_H
+
+// Code shared by the collectors of every program: the adjacency-list graph and its CSR form, the
+// side mark bitmap with the bounded-stack marker, the chunked block heap with its size classes and
+// per-thread caches, and reference counting with trial-deletion cycle collection and a zero count
+// table. Declared in namespace gccore, which each program's namespace pulls in. Every definition
+// is inline, so any number of translation units may include it and share one heap
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "Trace.h"
+#include "GCStats.h"
+#include "GCReport.h"
+#define CHUNK_SIZE (1 << 20) // the heap grows one mapped chunk at a time
+#define NUM_SIZE_CLASSES 6 // size classes of 16, 32, 64, 128, 256 and 512 bytes
+#define MIN_CLASS_SIZE 16
+#define TCACHE_COUNT 32 // blocks of one size class a thread caches before flushing half of them
+#define CLASS_LIST_LIMIT 1024 // free blocks a size class keeps before handing the rest back to first fit
+#define MARK_STACK_SIZE 4096
+
+namespace gccore {
+
+// Allocation policies supported by alloc(); a program may number its own after ALLOC_SEGREGATED
+enum { ALLOC_FIRST_FIT, ALLOC_SEGREGATED };
+
+// Colors used by the cycle collector
+enum { COLOR_BLACK, COLOR_GRAY, COLOR_WHITE, COLOR_PURPLE };
+
+struct Chunk;
+
+// Structure to represent a block of memory in the heap
+typedef struct Block {
+    size_t size;
+    int free; // 1 if the block is free, 0 if it's allocated
+    int size_class; // size class the block was carved for, -1 for first-fit blocks
+    struct Block *next; // Pointer to the next block in the linked list
+    struct Block *prev; // Pointer to the previous block in address order (boundary tag)
+    struct Chunk *chunk; // Chunk the block was carved from
+    struct Block *forward; // New location of a movable block while mark_compact() runs, NULL if it stays put
+} Block;
+
+// Structure to represent one mapped chunk of the heap
+typedef struct Chunk {
+    size_t size; // bytes mapped for the chunk, headers included
+    size_t free_bytes; // payload bytes in the chunk's general-pool free blocks, the ones first fit can use
+    int released; // 1 once the chunk's free pages have been returned with madvise
+    Block *first; // First block of the chunk's address-ordered block list
+    Block *first_free; // No block before this one is free in the general pool, NULL if none is
+    long index; // position in the chunk list, which only ever grows at its tail
+    struct Chunk *next; // Pointer to the next chunk of the heap
+} Chunk;
+
+// Define structure for a node in adjacency list
+typedef struct Node {
+    int data;
+    struct Node* next;
+} Node;
+
+// Define structure for adjacency list
+typedef struct {
+    Node** array;
+    int numVertices;
+} Graph;
+
+// Define structure for a side mark bitmap: bit v is set once vertex v is marked
+typedef struct {
+    uint64_t* words;
+    int numWords;
+    int numBits;
+} MarkBitmap;
+
+// Define structure for a graph in compressed sparse row form:
+// the targets of vertex v are targets[offsets[v]] .. targets[offsets[v + 1] - 1]
+typedef struct {
+    int* offsets;
+    int* targets;
+    int numVertices;
+    int numEdges;
+} CSRGraph;
+
+// Structure to represent the heap: edges stay in the sparse adjacency list, so its
+// memory grows with the number of live edges instead of with node_count squared
+typedef struct {
+    Graph* graph;
+    int* reference_counts;
+    char* is_root; // 1 while a root refers to the node
+    char* freed; // 1 once the node has been reclaimed
+    char* color; // cycle collector color, COLOR_BLACK when in use
+    char* buffered; // 1 while the node sits in cycle_roots
+    int* cycle_roots; // candidate roots of garbage cycles
+    int num_cycle_roots;
+    int cycle_roots_capacity;
+    int deferred; // 1 when root references are left uncounted (deferred reference counting)
+    int* zct; // zero count table: nodes whose count fell to zero while roots were uncounted
+    char* in_zct;
+    int zct_count;
+    int zct_capacity;
+    long count_updates; // reference count writes made by the mutator, the frees it cascades into included
+    long skipped_updates; // root updates that deferred mode did not count
+    int node_count;
+    void** payload; // memory of each object, freed with it when set
+    uint32_t* fields; // TRACE_MAX_SLOTS pointer fields of each object, cleared with it when set
+    bool block_nodes; // the graph's nodes come from alloc(), as try1's do, rather than malloc()
+} Heap;
+
+// The heap itself: a list of mapped chunks, each holding its own address-ordered block list
+inline Chunk *chunk_list = NULL;
+inline Chunk *chunk_tail = NULL;
+inline Chunk *fit_chunk = NULL; // every chunk before it has less than MIN_CLASS_SIZE bytes free, NULL if all have
+
+// Current allocation policy and one free list per size class
+inline int alloc_mode = ALLOC_FIRST_FIT;
+inline Block *class_free_lists[NUM_SIZE_CLASSES];
+inline int class_free_counts[NUM_SIZE_CLASSES];
+inline int quiet = 0; // set to suppress per-object messages, e.g. while replaying a trace
+
+// Set by a collector that leaves garbage for the allocator to reclaim, as try2's lazy sweep does:
+// reclaims a little of it, returning 0 once there is none left
+inline int (*heap_reclaim_step)() = NULL;
+
+// Function to map a new chunk able to hold at least 'min_size' bytes of payload
+inline Chunk *map_chunk(size_t min_size) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = sizeof(Chunk) + sizeof(Block) + min_size;
+    if (size < CHUNK_SIZE)
+        size = CHUNK_SIZE;
+    size = (size + page - 1) & ~(page - 1);
+
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return NULL;
+    Chunk *chunk = (Chunk *)base;
+    chunk->size = size;
+    chunk->released = 0;
+    chunk->next = NULL;
+    chunk->first = (Block *)(chunk + 1);
+    chunk->first->size = size - sizeof(Chunk) - sizeof(Block);
+    chunk->first->free = 1;
+    chunk->first->size_class = -1;
+    chunk->first->chunk = chunk;
+    chunk->first->next = NULL;
+    chunk->first->prev = NULL;
+    chunk->free_bytes = chunk->first->size;
+    chunk->first_free = chunk->first;
+    chunk->index = chunk_tail ? chunk_tail->index + 1 : 0;
+    if (fit_chunk == NULL)
+        fit_chunk = chunk;
+
+    if (chunk_tail)
+        chunk_tail->next = chunk;
+    else
+        chunk_list = chunk;
+    chunk_tail = chunk;
+    return chunk;
+}
+
+// Function to initialize the heap
+inline void init_heap() {
+    if (map_chunk(0) == NULL) {
+        fprintf(stderr, "Error: Unable to initialize heap\n");
+        exit(1);
+    }
+    for (int i = 0; i < NUM_SIZE_CLASSES; i++) {
+        class_free_lists[i] = NULL;
+        class_free_counts[i] = 0;
+    }
+}
+
+// Function to unmap every chunk and start an empty heap, forgetting any garbage left to reclaim
+inline void reset_heap() {
+    while (chunk_list) {
+        Chunk* next = chunk_list->next;
+        munmap(chunk_list, chunk_list->size);
+        chunk_list = next;
+    }
+    chunk_tail = NULL;
+    fit_chunk = NULL;
+    heap_reclaim_step = NULL;
+    init_heap();
+}
+
+// Function to select the allocation policy used by alloc()
+inline void set_alloc_mode(int mode) {
+    alloc_mode = mode;
+}
+
+// Function to find the smallest size class that fits 'size', -1 if it is too large
+inline int size_class_of(size_t size) {
+    int c = 0;
+    size_t class_size = MIN_CLASS_SIZE;
+    while (c < NUM_SIZE_CLASSES && class_size < size) {
+        class_size <<= 1;
+        c++;
+    }
+    return c < NUM_SIZE_CLASSES ? c : -1;
+}
+
+// A free block parked on a size-class list is not available to first-fit or merging
+inline int in_general_pool(Block *block) {
+    return block->free && block->size_class < 0;
+}
+
+// Function to move the first-fit starting chunk back to 'chunk' once it has room for a size class
+inline void note_free_bytes(Chunk *chunk) {
+    if (chunk->free_bytes >= MIN_CLASS_SIZE && (fit_chunk == NULL || chunk->index < fit_chunk->index))
+        fit_chunk = chunk;
+}
+
+// Function to absorb the physically next block into 'block'
+inline void merge_with_next(Block *block) {
+    Block *next = block->next;
+    block->size += sizeof(Block) + next->size;
+    block->next = next->next;
+    if (next->next)
+        next->next->prev = block;
+    block->chunk->free_bytes += sizeof(Block); // the absorbed header becomes payload
+    note_free_bytes(block->chunk);
+}
+
+// Function to merge a free block with its free physical neighbours in constant time
+inline Block *coalesce(Block *block) {
+    if (block->next && in_general_pool(block->next))
+        merge_with_next(block);
+    if (block->prev && in_general_pool(block->prev)) {
+        block = block->prev;
+        merge_with_next(block);
+    }
+    return block;
+}
+
+// Function to allocate 'size' bytes out of the free block 'curr', splitting off the remainder
+inline void *take_block(Block *curr, size_t size) {
+    Chunk *chunk = curr->chunk;
+    chunk->free_bytes -= curr->size;
+    if (curr->size >= size + sizeof(Block) + MIN_CLASS_SIZE) {
+        // Split the block if the remainder can hold the smallest size class; a smaller sliver is
+        // hardly ever reused and every later first-fit walk would have to step over it
+        Block *new_block = (Block *)((char *)curr + sizeof(Block) + size);
+       //to perform pointer arithmetic in terms of bytes rather than in terms of the size of the structure (Block structure) it points to.
+       	//Block *new_block = curr + size;
+        new_block->size = curr->size - size - sizeof(Block);
+        new_block->free = 1;
+        new_block->size_class = -1;
+        new_block->chunk = chunk;
+        new_block->next = curr->next;
+        new_block->prev = curr;
+        if (curr->next)
+            curr->next->prev = new_block;
+        curr->size = size;
+        curr->next = new_block;
+        chunk->free_bytes += new_block->size;
+    }
+    curr->free = 0;
+    chunk->released = 0;
+    return (void *)(curr + 1); // Return a pointer to the allocated memory
+}
+
+// Function to find a free block of at least 'size' bytes by walking the block lists with
+// first-fit, NULL if none is large enough
+inline void *fit_block(size_t size) {
+    // Requests of a size class or more start past the chunks too full for the smallest class
+    while (fit_chunk && fit_chunk->free_bytes < MIN_CLASS_SIZE)
+        fit_chunk = fit_chunk->next;
+    for (Chunk *chunk = size < MIN_CLASS_SIZE ? chunk_list : fit_chunk; chunk; chunk = chunk->next) {
+        // Skip chunks that cannot possibly hold the request
+        if (chunk->free_bytes < size)
+            continue;
+        // Traverse the linked list from the first free block to find a suitable one
+        Block *curr = chunk->first_free;
+        chunk->first_free = NULL;
+        while (curr) {
+            if (in_general_pool(curr)) {
+                if (chunk->first_free == NULL)
+                    chunk->first_free = curr;
+                // If the block is free and large enough, allocate from it
+                if (curr->size >= size)
+                    return take_block(curr, size);
+            }
+            curr = curr->next;
+        }
+    }
+    return NULL;
+}
+
+// Function to grow the heap by mapping another chunk and allocate 'size' bytes from it
+inline void *map_block(size_t size) {
+    Chunk *chunk = map_chunk(size);
+    if (chunk == NULL)
+        return NULL;
+    return take_block(chunk->first, size);
+}
+
+// Function to allocate memory with first-fit, growing the heap when no block fits. It never
+// sweeps, so collectors and the thread caches (under heap_lock) allocate through it
+inline void *alloc_first_fit(size_t size) {
+    void *ptr = fit_block(size);
+    return ptr ? ptr : map_block(size);
+}
+
+// Function to allocate memory with first-fit for the mutator: before growing the heap, the
+// garbage a collector left behind is reclaimed a little at a time
+inline void *alloc_sweeping(size_t size) {
+    void *ptr;
+    while ((ptr = fit_block(size)) == NULL && heap_reclaim_step && heap_reclaim_step())
+        ;
+    return ptr ? ptr : map_block(size);
+}
+
+// Function to allocate memory from the heap
+inline void *alloc(size_t size) {
+    if (alloc_mode == ALLOC_SEGREGATED) {
+        int c = size_class_of(size);
+        if (c >= 0) {
+            // Pop a cached block of this class, the free-list link lives in its payload
+            Block *block = class_free_lists[c];
+            if (block) {
+                class_free_lists[c] = *(Block **)(block + 1);
+                class_free_counts[c]--;
+                block->free = 0;
+                return (void *)(block + 1);
+            }
+            // Otherwise carve a new block of the full class size from the heap
+            void *ptr = alloc_sweeping((size_t)MIN_CLASS_SIZE << c);
+            if (ptr)
+                ((Block *)ptr - 1)->size_class = c;
+            return ptr;
+        }
+    }
+    // Large requests and the first-fit mode use the splitting path
+    return alloc_sweeping(size);
+}
+
+// Function to mark a block free, parking size-class blocks on their list; returns 1 if it needs merging
+inline int release_block(Block *block) {
+    block->free = 1;
+    int c = block->size_class;
+    if (c >= 0) {
+        if (class_free_counts[c] < CLASS_LIST_LIMIT) {
+            *(Block **)(block + 1) = class_free_lists[c];
+            class_free_lists[c] = block;
+            class_free_counts[c]++;
+            return 0;
+        }
+        // The class already caches enough blocks, so this one rejoins the general pool and can
+        // merge back into larger blocks instead of staying split off for good
+        block->size_class = -1;
+    }
+    Chunk *chunk = block->chunk;
+    chunk->free_bytes += block->size;
+    if (chunk->first_free == NULL || block < chunk->first_free)
+        chunk->first_free = block;
+    note_free_bytes(chunk);
+    return 1;
+}
+
+// Function to free a block without reporting it, for callers that report a whole batch at once
+inline void release_mem(void *ptr) {
+    Block *block = (Block *)ptr - 1;
+    // Size-class blocks go back on their list without merging,
+    // everything else merges with its neighbours through the boundary tags
+    if (release_block(block))
+        coalesce(block);
+}
+
+// Function to report a batch of freed blocks in one line
+inline void report_blocks_freed(int freed) {
+    if (freed > 0 && !quiet && gc_report_verbose())
+        printf("%d blocks freed successfully!\n", freed);
+}
+
+// Function to free memory allocated from the heap
+inline void free_mem(void *ptr) {
+    if (ptr == NULL)
+        return;
+    size_t size = ((Block *)ptr - 1)->size; // coalescing may fold the block into its neighbour
+    release_mem(ptr);
+    if (!quiet && gc_report_object("block_freed", -1, size))
+        printf("Block freed successfully!\n");
+    
+}
+
+// Function to hand the pages of completely free chunks back to the OS
+inline int release_free_chunks() {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    int released = 0;
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        Block *first = chunk->first;
+        if (chunk->released || first->next != NULL || !in_general_pool(first))
+            continue;
+        // Keep the page holding the chunk and block headers, drop the rest of the payload
+        uintptr_t start = ((uintptr_t)(first + 1) + page - 1) & ~(uintptr_t)(page - 1);
+        uintptr_t end = (uintptr_t)chunk + chunk->size;
+        if (start < end)
+            madvise((void *)start, end - start, MADV_DONTNEED);
+        chunk->released = 1;
+        released++;
+    }
+    return released;
+}
+
+// Function to free a batch of blocks with a single coalescing pass over the heap
+inline void free_mem_many(void **ptrs, int count) {
+    int freed = 0;
+    for (int i = 0; i < count; i++) {
+        if (ptrs[i] == NULL)
+            continue;
+        release_block((Block *)ptrs[i] - 1);
+        freed++;
+    }
+    if (freed == 0)
+        return;
+
+    // Merge adjacent free blocks
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        Block *curr = chunk->first;
+        while (curr) {
+            while (in_general_pool(curr) && curr->next && in_general_pool(curr->next))
+                merge_with_next(curr);
+            curr = curr->next;
+        }
+    }
+    release_free_chunks();
+    report_blocks_freed(freed);
+}
+
+// Function to measure external fragmentation: 1 - largest free block / total free bytes
+inline double heap_fragmentation() {
+    size_t total_free = 0, largest_free = 0;
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        for (Block *curr = chunk->first; curr; curr = curr->next) {
+            if (curr->free) {
+                total_free += curr->size;
+                if (in_general_pool(curr) && curr->size > largest_free)
+                    largest_free = curr->size;
+            }
+        }
+    }
+    if (total_free == 0)
+        return 0.0;
+    return 1.0 - (double)largest_free / (double)total_free;
+}
+
+// Function to count the free blocks, both those parked on the size-class lists and those in the
+// general pool
+inline long free_block_count() {
+    long count = 0;
+    for (int c = 0; c < NUM_SIZE_CLASSES; c++) {
+        for (Block *block = class_free_lists[c]; block; block = *(Block **)(block + 1))
+            count++;
+    }
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        for (Block *block = chunk->first_free; block; block = block->next) {
+            if (in_general_pool(block))
+                count++;
+        }
+    }
+    return count;
+}
+
+// alloc() and free_mem() assume a single thread. alloc_mt() and free_mt() may be called from
+// many threads: each thread keeps a small cache of free blocks per size class and only takes
+// heap_lock to refill or flush a batch, or for large first-fit requests. Do not mix the two
+// families while other threads are allocating
+inline pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Structure to represent one thread's cache of free size-class blocks
+typedef struct {
+    Block *bins[NUM_SIZE_CLASSES]; // linked through the payload like class_free_lists
+    int counts[NUM_SIZE_CLASSES];
+} TCache;
+
+inline thread_local TCache tcache;
+
+// Function to refill one class of the calling thread's cache with half a cache worth of blocks
+inline void tcache_refill(int c) {
+    pthread_mutex_lock(&heap_lock);
+    while (tcache.counts[c] < TCACHE_COUNT / 2) {
+        Block *block = class_free_lists[c];
+        if (block) {
+            class_free_lists[c] = *(Block **)(block + 1);
+            class_free_counts[c]--;
+            block->free = 0;
+        } else {
+            void *ptr = alloc_first_fit((size_t)MIN_CLASS_SIZE << c);
+            if (ptr == NULL)
+                break;
+            block = (Block *)ptr - 1;
+            block->size_class = c;
+        }
+        *(Block **)(block + 1) = tcache.bins[c];
+        tcache.bins[c] = block;
+        tcache.counts[c]++;
+    }
+    pthread_mutex_unlock(&heap_lock);
+}
+
+// Function to return 'keep' fewer blocks than are cached for one class to the shared heap
+inline void tcache_flush_class(int c, int keep) {
+    pthread_mutex_lock(&heap_lock);
+    while (tcache.counts[c] > keep) {
+        Block *block = tcache.bins[c];
+        tcache.bins[c] = *(Block **)(block + 1);
+        tcache.counts[c]--;
+        if (release_block(block))
+            coalesce(block);
+    }
+    pthread_mutex_unlock(&heap_lock);
+}
+
+// Function to hand every block cached by the calling thread back to the heap, call it before a thread exits
+inline void tcache_flush() {
+    for (int c = 0; c < NUM_SIZE_CLASSES; c++) {
+        if (tcache.counts[c] > 0)
+            tcache_flush_class(c, 0);
+    }
+}
+
+// Function to allocate memory from the heap from any thread
+inline void *alloc_mt(size_t size) {
+    int c = size_class_of(size);
+    if (c < 0) {
+        pthread_mutex_lock(&heap_lock);
+        void *ptr = alloc_first_fit(size);
+        pthread_mutex_unlock(&heap_lock);
+        return ptr;
+    }
+    if (tcache.counts[c] == 0) {
+        tcache_refill(c);
+        if (tcache.counts[c] == 0)
+            return NULL;
+    }
+    Block *block = tcache.bins[c];
+    tcache.bins[c] = *(Block **)(block + 1);
+    tcache.counts[c]--;
+    return (void *)(block + 1);
+}
+
+// Function to free memory allocated by alloc_mt() from any thread
+inline void free_mt(void *ptr) {
+    if (ptr == NULL)
+        return;
+    Block *block = (Block *)ptr - 1;
+    int c = block->size_class;
+    if (c < 0) {
+        pthread_mutex_lock(&heap_lock);
+        if (release_block(block))
+            coalesce(block);
+        pthread_mutex_unlock(&heap_lock);
+        return;
+    }
+    *(Block **)(block + 1) = tcache.bins[c];
+    tcache.bins[c] = block;
+    if (++tcache.counts[c] > TCACHE_COUNT)
+        tcache_flush_class(c, TCACHE_COUNT / 2);
+}
+
+// Structure to pass the microbenchmark parameters to each thread
+typedef struct {
+    int ops;
+    unsigned seed;
+} AllocBenchArgs;
+
+// Function to run one thread of the microbenchmark: a ring of live blocks is replaced one at a time
+inline void *alloc_bench_thread(void *arg) {
+    AllocBenchArgs *args = (AllocBenchArgs *)arg;
+    void *live[64] = {NULL};
+    unsigned state = args->seed;
+    for (int i = 0; i < args->ops; i++) {
+        int slot = i & 63;
+        free_mt(live[slot]);
+        live[slot] = alloc_mt((size_t)MIN_CLASS_SIZE << (rand_r(&state) % NUM_SIZE_CLASSES));
+    }
+    for (int slot = 0; slot < 64; slot++)
+        free_mt(live[slot]);
+    tcache_flush();
+    return NULL;
+}
+
+// Function to measure alloc_mt()/free_mt() pairs per second with 'num_threads' threads
+inline double alloc_mt_benchmark(int num_threads, int ops_per_thread) {
+    pthread_t *threads = (pthread_t *)malloc(num_threads * sizeof(pthread_t));
+    AllocBenchArgs *args = (AllocBenchArgs *)malloc(num_threads * sizeof(AllocBenchArgs));
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < num_threads; t++) {
+        args[t].ops = ops_per_thread;
+        args[t].seed = (unsigned)t + 1;
+        pthread_create(&threads[t], NULL, alloc_bench_thread, &args[t]);
+    }
+    for (int t = 0; t < num_threads; t++)
+        pthread_join(threads[t], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(threads);
+    free(args);
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    return seconds > 0 ? (double)num_threads * ops_per_thread / seconds : 0.0;
+}
+
+// Function to build a CSR graph from parallel arrays of edge sources and destinations
+inline CSRGraph* createCSRGraph(int numVertices, const int* src, const int* dest, int numEdges) {
+    CSRGraph* csr = (CSRGraph*)malloc(sizeof(CSRGraph));
+    csr->numVertices = numVertices;
+    csr->numEdges = numEdges;
+    csr->offsets = (int*)calloc(numVertices + 1, sizeof(int));
+    csr->targets = (int*)malloc((numEdges > 0 ? numEdges : 1) * sizeof(int));
+    // Count the out-degree of every vertex, then turn the counts into offsets
+    for (int e = 0; e < numEdges; e++)
+        csr->offsets[src[e] + 1]++;
+    for (int v = 0; v < numVertices; v++)
+        csr->offsets[v + 1] += csr->offsets[v];
+    // Scatter the targets, using a cursor per vertex
+    int* cursor = (int*)malloc((numVertices > 0 ? numVertices : 1) * sizeof(int));
+    memcpy(cursor, csr->offsets, numVertices * sizeof(int));
+    for (int e = 0; e < numEdges; e++)
+        csr->targets[cursor[src[e]]++] = dest[e];
+    free(cursor);
+    return csr;
+}
+
+// Function to convert an adjacency list graph to CSR form in a single pass over its edges
+inline CSRGraph* graph_to_csr(Graph* graph) {
+    CSRGraph* csr = (CSRGraph*)malloc(sizeof(CSRGraph));
+    int capacity = 16;
+    csr->numVertices = graph->numVertices;
+    csr->numEdges = 0;
+    csr->offsets = (int*)malloc((graph->numVertices + 1) * sizeof(int));
+    csr->targets = (int*)malloc(capacity * sizeof(int));
+    for (int i = 0; i < graph->numVertices; i++) {
+        csr->offsets[i] = csr->numEdges;
+        for (Node* temp = graph->array[i]; temp; temp = temp->next) {
+            if (csr->numEdges == capacity) {
+                capacity *= 2;
+                csr->targets = (int*)realloc(csr->targets, capacity * sizeof(int));
+            }
+            csr->targets[csr->numEdges++] = temp->data;
+        }
+    }
+    csr->offsets[graph->numVertices] = csr->numEdges;
+    return csr;
+}
+
+// Function to release a CSR graph
+inline void freeCSRGraph(CSRGraph* csr) {
+    free(csr->offsets);
+    free(csr->targets);
+    free(csr);
+}
+
+// Function to create a cleared mark bitmap for 'numBits' objects
+inline MarkBitmap* createMarkBitmap(int numBits) {
+    MarkBitmap* marks = (MarkBitmap*)malloc(sizeof(MarkBitmap));
+    marks->numBits = numBits;
+    marks->numWords = (numBits + 63) / 64;
+    marks->words = (uint64_t*)calloc(marks->numWords > 0 ? marks->numWords : 1, sizeof(uint64_t));
+    return marks;
+}
+
+// Function to clear every mark bit before a new collection
+inline void clearMarkBitmap(MarkBitmap* marks) {
+    memset(marks->words, 0, marks->numWords * sizeof(uint64_t));
+}
+
+// Function to release a mark bitmap
+inline void freeMarkBitmap(MarkBitmap* marks) {
+    free(marks->words);
+    free(marks);
+}
+
+inline bool is_marked(MarkBitmap* marks, int v) {
+    return (marks->words[v >> 6] >> (v & 63)) & 1;
+}
+
+inline void set_mark(MarkBitmap* marks, int v) {
+    marks->words[v >> 6] |= (uint64_t)1 << (v & 63);
+}
+
+// Function to find the first unmarked index at or after 'from', -1 if there is none.
+// Whole words of marked objects are skipped 64 at a time
+inline int next_unmarked(MarkBitmap* marks, int from) {
+    if (from >= marks->numBits)
+        return -1;
+    int w = from >> 6;
+    uint64_t free_bits = ~marks->words[w] & (~(uint64_t)0 << (from & 63));
+    while (free_bits == 0) {
+        if (++w >= marks->numWords)
+            return -1;
+        free_bits = ~marks->words[w];
+    }
+    int v = (w << 6) + __builtin_ctzll(free_bits);
+    return v < marks->numBits ? v : -1;
+}
+
+// Reusable bitmap for the collectors that finish within their pause, grown when the graph outgrows it
+inline MarkBitmap* collector_marks = NULL;
+
+// Function to get '*marks' cleared and sized to 'numBits' objects, reusing its words if they suffice
+inline MarkBitmap* reuse_bitmap(MarkBitmap** marks, int numBits) {
+    if (*marks == NULL || (*marks)->numBits < numBits) {
+        if (*marks)
+            freeMarkBitmap(*marks);
+        *marks = createMarkBitmap(numBits);
+    } else {
+        // A smaller graph than the last one: only its own bits may be swept
+        (*marks)->numBits = numBits;
+        (*marks)->numWords = (numBits + 63) / 64;
+        clearMarkBitmap(*marks);
+    }
+    return *marks;
+}
+
+inline MarkBitmap* collector_bitmap(int numBits) {
+    return reuse_bitmap(&collector_marks, numBits);
+}
+
+// Function to perform depth-first search (DFS) recursively
+inline void DFS(Graph* graph, int vertex, MarkBitmap* marks) {
+    // Mark the current vertex as visited
+    set_mark(marks, vertex);
+    // Traverse all adjacent vertices of the current vertex
+    Node* current = graph->array[vertex];
+    while (current != NULL) {
+        int adjacentVertex = current->data;
+        if (!is_marked(marks, adjacentVertex)) {
+            // If the adjacent vertex is not visited, recursively call DFS
+            DFS(graph, adjacentVertex, marks);
+        }
+        current = current->next;
+    }
+}
+
+// Reusable mark stack shared by every collection; when it is full the pushed
+// vertex stays marked and its children are recovered by rescanning the marked set
+inline int mark_stack[MARK_STACK_SIZE];
+inline int mark_stack_top = 0;
+inline bool mark_stack_overflowed = false;
+
+// Function to mark a vertex and push it on the mark stack
+inline void mark_push(int vertex, MarkBitmap* marks) {
+    set_mark(marks, vertex);
+    GC_STATS_VISIT(1, 0);
+    if (mark_stack_top < MARK_STACK_SIZE)
+        mark_stack[mark_stack_top++] = vertex;
+    else
+        mark_stack_overflowed = true;
+    GC_STATS_MARK_STACK(mark_stack_top);
+}
+
+// Function to perform depth-first search (DFS) iteratively with the explicit mark stack
+inline void DFS_iterative(Graph* graph, int vertex, MarkBitmap* marks) {
+    mark_stack_top = 0;
+    mark_stack_overflowed = false;
+    mark_push(vertex, marks);
+    while (mark_stack_top > 0 || mark_stack_overflowed) {
+        while (mark_stack_top > 0) {
+            Node* current = graph->array[mark_stack[--mark_stack_top]];
+            for (; current != NULL; current = current->next) {
+                GC_STATS_VISIT(0, sizeof(Node));
+                if (!is_marked(marks, current->data))
+                    mark_push(current->data, marks);
+            }
+        }
+        if (mark_stack_overflowed) {
+            // Rescan: any marked vertex may have children that were never pushed
+            mark_stack_overflowed = false;
+            for (int i = 0; i < graph->numVertices; i++) {
+                if (!is_marked(marks, i))
+                    continue;
+                for (Node* current = graph->array[i]; current != NULL; current = current->next) {
+                    if (!is_marked(marks, current->data))
+                        mark_push(current->data, marks);
+                }
+            }
+        }
+    }
+}
+
+// Function to initialize the heap over the edges of 'graph'. With 'block_nodes' the graph's nodes,
+// and the ones add_ref() stores, come from the block heap, otherwise from malloc()
+inline void initialize_heap(Heap *heap, Graph* graph, bool block_nodes = false) {
+    heap->graph = graph;
+    heap->node_count = graph->numVertices;
+    heap->reference_counts = (int*)calloc(graph->numVertices, sizeof(int));
+    heap->is_root = (char*)calloc(graph->numVertices, sizeof(char));
+    heap->freed = (char*)calloc(graph->numVertices, sizeof(char));
+    heap->color = (char*)calloc(graph->numVertices, sizeof(char));
+    heap->buffered = (char*)calloc(graph->numVertices, sizeof(char));
+    heap->cycle_roots = NULL;
+    heap->num_cycle_roots = 0;
+    heap->cycle_roots_capacity = 0;
+    heap->deferred = 0;
+    heap->zct = NULL;
+    heap->in_zct = (char*)calloc(graph->numVertices, sizeof(char));
+    heap->zct_count = 0;
+    heap->zct_capacity = 0;
+    heap->count_updates = 0;
+    heap->skipped_updates = 0;
+    heap->payload = NULL;
+    heap->fields = NULL;
+    heap->block_nodes = block_nodes;
+}
+
+// Function to allocate the node of a counted reference where the heap's graph keeps its nodes
+inline Node* rc_new_node(Heap *heap, int data) {
+    Node* node = (Node*)(heap->block_nodes ? alloc(sizeof(Node)) : malloc(sizeof(Node)));
+    if (node == NULL) {
+        fprintf(stderr, "Error: Heap exhausted\n");
+        exit(1);
+    }
+    node->data = data;
+    node->next = NULL;
+    return node;
+}
+
+// Function to free a node of the heap's graph without reporting it
+inline void rc_free_node(Heap *heap, void *node) {
+    if (heap->block_nodes)
+        release_mem(node);
+    else
+        free(node);
+}
+
+// Function to report the blocks a release freed, as one batch; malloc()ed nodes are not blocks
+inline void rc_report_blocks(Heap *heap, int blocks) {
+    if (heap->block_nodes)
+        report_blocks_freed(blocks);
+}
+
+// Function to release the heap's graph and bookkeeping; the payloads stay with whoever set them
+inline void free_heap(Heap *heap) {
+    for (int i = 0; i < heap->graph->numVertices; i++) {
+        while (heap->graph->array[i]) {
+            Node* next = heap->graph->array[i]->next;
+            rc_free_node(heap, heap->graph->array[i]);
+            heap->graph->array[i] = next;
+        }
+    }
+    free(heap->graph->array);
+    rc_free_node(heap, heap->graph);
+    free(heap->reference_counts);
+    free(heap->is_root);
+    free(heap->freed);
+    free(heap->color);
+    free(heap->buffered);
+    free(heap->cycle_roots);
+    free(heap->zct);
+    free(heap->in_zct);
+}
+
+// Function to increment reference count for a node
+inline void increment_reference_count(Heap *heap, int node) {
+    heap->reference_counts[node]++;
+}
+
+// Function to decrement reference count for a node
+inline void decrement_reference_count(Heap *heap, int node) {
+    heap->reference_counts[node]--;
+}
+
+// Function to buffer a node whose count was decremented without reaching zero;
+// it may be the last external reference into a garbage cycle. A rooted node cannot be, it is
+// buffered once its root goes
+inline void possible_root(Heap *heap, int node) {
+    if (heap->color[node] == COLOR_PURPLE || heap->is_root[node])
+        return;
+    heap->color[node] = COLOR_PURPLE;
+    if (heap->buffered[node])
+        return;
+    heap->buffered[node] = 1;
+    if (heap->num_cycle_roots == heap->cycle_roots_capacity) {
+        heap->cycle_roots_capacity = heap->cycle_roots_capacity ? heap->cycle_roots_capacity * 2 : 16;
+        heap->cycle_roots = (int*)realloc(heap->cycle_roots, heap->cycle_roots_capacity * sizeof(int));
+    }
+    heap->cycle_roots[heap->num_cycle_roots++] = node;
+}
+
+// Function to free the memory of a reclaimed object and clear its fields, so neither outlives it;
+// returns the number of blocks freed
+inline int release_payload(Heap *heap, int node) {
+    if (heap->fields)
+        memset(&heap->fields[(size_t)node * TRACE_MAX_SLOTS], 0xFF, TRACE_MAX_SLOTS * sizeof(uint32_t));
+    if (heap->payload == NULL || heap->payload[node] == NULL)
+        return 0;
+    release_mem(heap->payload[node]);
+    heap->payload[node] = NULL;
+    return 1;
+}
+
+// Explicit stack shared by the cycle collector's traversals
+inline int* cycle_stack = NULL;
+inline int cycle_stack_top = 0, cycle_stack_capacity = 0;
+
+inline void cycle_push(int node) {
+    if (cycle_stack_top == cycle_stack_capacity) {
+        cycle_stack_capacity = cycle_stack_capacity ? cycle_stack_capacity * 2 : 64;
+        cycle_stack = (int*)realloc(cycle_stack, cycle_stack_capacity * sizeof(int));
+    }
+    cycle_stack[cycle_stack_top++] = node;
+    GC_STATS_MARK_STACK(cycle_stack_top);
+}
+
+// Function to color the subgraph below 'node' gray, removing the counts its internal edges contribute
+inline void mark_gray(Heap *heap, int node) {
+    if (heap->color[node] == COLOR_GRAY)
+        return;
+    heap->color[node] = COLOR_GRAY;
+    cycle_push(node);
+    while (cycle_stack_top > 0) {
+        int v = cycle_stack[--cycle_stack_top];
+        GC_STATS_VISIT(1, 0);
+        for (Node* temp = heap->graph->array[v]; temp; temp = temp->next) {
+            GC_STATS_VISIT(0, sizeof(Node));
+            decrement_reference_count(heap, temp->data);
+            if (heap->color[temp->data] != COLOR_GRAY) {
+                heap->color[temp->data] = COLOR_GRAY;
+                cycle_push(temp->data);
+            }
+        }
+    }
+}
+
+// Function to recolor black everything reachable from an externally referenced node, restoring its counts
+inline void scan_black(Heap *heap, int node) {
+    heap->color[node] = COLOR_BLACK;
+    int base = cycle_stack_top;
+    cycle_push(node);
+    while (cycle_stack_top > base) {
+        int v = cycle_stack[--cycle_stack_top];
+        for (Node* temp = heap->graph->array[v]; temp; temp = temp->next) {
+            increment_reference_count(heap, temp->data);
+            if (heap->color[temp->data] != COLOR_BLACK) {
+                heap->color[temp->data] = COLOR_BLACK;
+                cycle_push(temp->data);
+            }
+        }
+    }
+}
+
+// Function to split the gray subgraph into live (black) and garbage (white) nodes. A root is an
+// external reference even when its count leaves it out, as deferred mode does, so it is never whitened
+inline void scan(Heap *heap, int node) {
+    cycle_push(node);
+    while (cycle_stack_top > 0) {
+        int v = cycle_stack[--cycle_stack_top];
+        if (heap->color[v] != COLOR_GRAY)
+            continue;
+        if (heap->reference_counts[v] > 0 || heap->is_root[v]) {
+            scan_black(heap, v);
+        } else {
+            heap->color[v] = COLOR_WHITE;
+            for (Node* temp = heap->graph->array[v]; temp; temp = temp->next)
+                cycle_push(temp->data);
+        }
+    }
+}
+
+// Function to free the white nodes below 'node'; edges between them are dropped without counting.
+// The blocks freed are added to 'blocks' so the collection reports them once
+inline int collect_white(Heap *heap, int node, int *blocks) {
+    int freed = 0;
+    if (heap->color[node] != COLOR_WHITE || heap->buffered[node])
+        return 0;
+    heap->color[node] = COLOR_BLACK;
+    cycle_push(node);
+    while (cycle_stack_top > 0) {
+        int v = cycle_stack[--cycle_stack_top];
+        if (!quiet && gc_report_object("freed", v, sizeof(v) + sizeof(Node)))
+            printf("node value=%d , memory freed=%d\n", v, (int)(sizeof(v)+sizeof(Node)));
+        GC_STATS_FREE(1, sizeof(v) + sizeof(Node));
+        *blocks += release_payload(heap, v);
+        heap->freed[v] = 1;
+        freed++;
+        Node* current = heap->graph->array[v];
+        heap->graph->array[v] = NULL;
+        while (current) {
+            int child = current->data;
+            Node* temp = current;
+            current = current->next;
+            rc_free_node(heap, temp);
+            (*blocks)++;
+            if (heap->color[child] == COLOR_WHITE && !heap->buffered[child]) {
+                heap->color[child] = COLOR_BLACK;
+                cycle_push(child);
+            }
+        }
+    }
+    return freed;
+}
+
+inline int reconcile_zct(Heap *heap);
+
+// Function to reclaim garbage cycles (Bacon-Rajan trial deletion). Only the subgraphs below the
+// buffered candidate roots are traversed, so the pause tracks their size rather than the heap's.
+// In deferred mode the zero count table is reconciled first, so every count is exact again
+inline int collect_cycles(Heap *heap) {
+    int i, kept = 0, freed = 0, blocks = 0;
+    if (heap->deferred)
+        freed += reconcile_zct(heap);
+    // The candidate buffer is the root set, trial deletion and the rescan are the mark
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    // Mark roots: trial-delete the internal counts below every still-purple candidate
+    for (i = 0; i < heap->num_cycle_roots; i++) {
+        int s = heap->cycle_roots[i];
+        if (heap->color[s] == COLOR_PURPLE && heap->reference_counts[s] > 0 && !heap->freed[s]) {
+            mark_gray(heap, s);
+            heap->cycle_roots[kept++] = s;
+        } else {
+            heap->buffered[s] = 0;
+        }
+    }
+    heap->num_cycle_roots = kept;
+    // Scan roots: nodes still referenced from outside turn black again
+    for (i = 0; i < heap->num_cycle_roots; i++)
+        scan(heap, heap->cycle_roots[i]);
+    // Collect roots: whatever stayed white is cyclic garbage
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+    for (i = 0; i < heap->num_cycle_roots; i++)
+        heap->buffered[heap->cycle_roots[i]] = 0;
+    for (i = 0; i < heap->num_cycle_roots; i++)
+        freed += collect_white(heap, heap->cycle_roots[i], &blocks);
+    heap->num_cycle_roots = 0;
+    GC_STATS_END_COLLECTION(heap->block_nodes ? free_block_count() : 0);
+    rc_report_blocks(heap, blocks);
+    return freed;
+}
+
+// Function to record a node whose count is zero but that a root might still refer to
+inline void zct_add(Heap *heap, int node) {
+    if (heap->in_zct[node])
+        return;
+    heap->in_zct[node] = 1;
+    if (heap->zct_count == heap->zct_capacity) {
+        heap->zct_capacity = heap->zct_capacity ? heap->zct_capacity * 2 : 16;
+        heap->zct = (int*)realloc(heap->zct, heap->zct_capacity * sizeof(int));
+    }
+    heap->zct[heap->zct_count++] = node;
+}
+
+// Function to free an object whose count reached zero, cascading through the objects it references.
+// A worklist is used instead of recursion so long chains cannot overflow the call stack. Returns
+// the number of blocks freed, for the caller to report with its own
+inline int release_object(Heap *heap, int node) {
+    int top = 0, capacity = 16, blocks = 0;
+    int* worklist = (int*)malloc(capacity * sizeof(int));
+    heap->freed[node] = 1;
+    worklist[top++] = node;
+    while (top > 0) {
+        int v = worklist[--top];
+        if (!quiet && gc_report_object("freed", v, sizeof(v) + sizeof(Node)))
+            printf("node value=%d , memory freed=%d\n", v, (int)(sizeof(v)+sizeof(Node)));
+        GC_STATS_FREE(1, sizeof(v) + sizeof(Node));
+        blocks += release_payload(heap, v);
+        Node* current = heap->graph->array[v];
+        heap->graph->array[v] = NULL;
+        while (current) {
+            int child = current->data;
+            Node* temp = current;
+            current = current->next;
+            rc_free_node(heap, temp);
+            blocks++;
+            decrement_reference_count(heap, child);
+            heap->count_updates++;
+            if (heap->reference_counts[child] == 0 && heap->is_root[child]) {
+                // Only an uncounted root keeps it alive; recheck at the next checkpoint
+                zct_add(heap, child);
+            } else if (heap->reference_counts[child] == 0 && !heap->freed[child]) {
+                if (top == capacity) {
+                    capacity *= 2;
+                    worklist = (int*)realloc(worklist, capacity * sizeof(int));
+                }
+                heap->freed[child] = 1;
+                worklist[top++] = child;
+            } else if (heap->reference_counts[child] > 0) {
+                possible_root(heap, child);
+            }
+        }
+    }
+    free(worklist);
+    return blocks;
+}
+
+// Function to store a reference src -> dst, counting it immediately
+inline void add_ref(Heap *heap, int src, int dst) {
+    Node* edge = rc_new_node(heap, dst);
+    edge->next = heap->graph->array[src];
+    heap->graph->array[src] = edge;
+    increment_reference_count(heap, dst);
+    heap->count_updates++;
+}
+
+// Function to delete one reference src -> dst; dst is freed at once if nothing else refers to it
+inline void drop_ref(Heap *heap, int src, int dst) {
+    Node** link = &heap->graph->array[src];
+    while (*link && (*link)->data != dst)
+        link = &(*link)->next;
+    if (*link == NULL)
+        return;
+    Node* temp = *link;
+    *link = temp->next;
+    rc_free_node(heap, temp);
+    int blocks = 1;
+    decrement_reference_count(heap, dst);
+    heap->count_updates++;
+    if (heap->reference_counts[dst] == 0 && heap->deferred)
+        zct_add(heap, dst);
+    else if (heap->reference_counts[dst] == 0 && !heap->is_root[dst] && !heap->freed[dst])
+        blocks += release_object(heap, dst);
+    else if (heap->reference_counts[dst] > 0)
+        possible_root(heap, dst);
+    rc_report_blocks(heap, blocks);
+}
+
+// Function to make a node a root; a root holds one reference to its node
+inline void set_root(Heap *heap, int node) {
+    if (heap->is_root[node])
+        return;
+    heap->is_root[node] = 1;
+    if (heap->deferred) {
+        heap->skipped_updates++;
+        return;
+    }
+    increment_reference_count(heap, node);
+    heap->count_updates++;
+}
+
+// Function to remove a root, freeing the node if that was its last reference
+inline void clear_root(Heap *heap, int node) {
+    if (!heap->is_root[node])
+        return;
+    heap->is_root[node] = 0;
+    if (heap->deferred) {
+        heap->skipped_updates++;
+        if (heap->reference_counts[node] == 0)
+            zct_add(heap, node);
+        else
+            possible_root(heap, node); // the heap references left may all come from a garbage cycle
+        return;
+    }
+    decrement_reference_count(heap, node);
+    heap->count_updates++;
+    if (heap->reference_counts[node] == 0 && !heap->freed[node])
+        rc_report_blocks(heap, release_object(heap, node));
+    else if (heap->reference_counts[node] > 0)
+        possible_root(heap, node);
+}
+
+// Function to reconcile the zero count table against a scan of the roots: entries that are neither
+// referenced from the heap nor from a root are freed, root-referenced ones stay for the next checkpoint
+inline int reconcile_zct(Heap *heap) {
+    int i, freed = 0, blocks = 0;
+    int count = heap->zct_count;
+    int* entries = heap->zct;
+    // Take the table over so nodes reaching zero during the frees start a fresh one
+    heap->zct = NULL;
+    heap->zct_count = 0;
+    heap->zct_capacity = 0;
+    for (i = 0; i < count; i++) {
+        int v = entries[i];
+        heap->in_zct[v] = 0;
+        if (heap->freed[v] || heap->reference_counts[v] > 0)
+            continue;
+        if (heap->is_root[v]) {
+            zct_add(heap, v);
+            continue;
+        }
+        blocks += release_object(heap, v);
+        freed++;
+    }
+    free(entries);
+    rc_report_blocks(heap, blocks);
+    return freed;
+}
+
+// Function to switch between counting every root reference and deferring root references
+inline void set_deferred_mode(Heap *heap, int deferred) {
+    int v;
+    if (heap->deferred == deferred)
+        return;
+    if (deferred) {
+        // Roots stop holding a count
+        for (v = 0; v < heap->node_count; v++) {
+            if (heap->is_root[v] && !heap->freed[v]) {
+                decrement_reference_count(heap, v);
+                if (heap->reference_counts[v] == 0)
+                    zct_add(heap, v);
+            }
+        }
+        heap->deferred = 1;
+    } else {
+        reconcile_zct(heap);
+        heap->deferred = 0;
+        for (v = 0; v < heap->node_count; v++) {
+            if (heap->is_root[v] && !heap->freed[v])
+                increment_reference_count(heap, v);
+        }
+    }
+}
+
+} // namespace gccore
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef GCREPORT_H
+#define GCREPORT_H
+
+// Garbage reports. The default verbose mode prints one line per freed object and every element
+// of the adjacency printouts, as the programs always have. GC_REPORT=summary keeps only the
+// totals, and GC_REPORT=ndjson:<path> also drops the per-object lines but records each freed
+// object as one JSON line in a buffer that goes to <path> in GC_REPORT_BUFFER-byte writes, so
+// reporting a sweep over millions of objects costs a few stores per object instead of a printf
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#define GC_REPORT_BUFFER (1 << 20)
+#define GC_REPORT_MAX_RECORD 128 // longest record, with an event name of up to 32 characters
+
+// Report modes
+enum { GC_REPORT_VERBOSE, GC_REPORT_SUMMARY, GC_REPORT_NDJSON };
+
+// Structure to represent the report being written
+typedef struct {
+    int mode;
+    FILE* file; // NDJSON output, NULL unless mode is GC_REPORT_NDJSON
+    char* buffer;
+    size_t used;
+    long records;
+} GCReport;
+
+inline GCReport gc_report = {GC_REPORT_VERBOSE, NULL, NULL, 0, 0};
+
+// Function to write out the buffered records
+inline void gc_report_flush() {
+    if (gc_report.file && gc_report.used) {
+        fwrite(gc_report.buffer, 1, gc_report.used, gc_report.file);
+        gc_report.used = 0;
+    }
+}
+
+// Function to flush and close the NDJSON report and go back to verbose mode
+inline void gc_report_close() {
+    gc_report_flush();
+    if (gc_report.file)
+        fclose(gc_report.file);
+    free(gc_report.buffer);
+    gc_report.file = NULL;
+    gc_report.buffer = NULL;
+    gc_report.mode = GC_REPORT_VERBOSE;
+}
+
+// Function to append a non-negative decimal number to a record
+inline char* gc_report_put_number(char* p, unsigned long v) {
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n > 0)
+        *p++ = digits[--n];
+    return p;
+}
+
+// Function to append a string to a record
+inline char* gc_report_put(char* p, const char* s) {
+    while (*s)
+        *p++ = *s++;
+    return p;
+}
+
+// Function to report one freed object, 'node' < 0 when it has no vertex number. Returns true
+// in verbose mode, where the caller prints its own line for the object
+inline bool gc_report_object(const char* event, long node, long bytes) {
+    if (gc_report.mode == GC_REPORT_VERBOSE)
+        return true;
+    if (gc_report.mode == GC_REPORT_NDJSON) {
+        if (GC_REPORT_BUFFER - gc_report.used < GC_REPORT_MAX_RECORD)
+            gc_report_flush();
+        char* p = gc_report.buffer + gc_report.used;
+        p = gc_report_put(p, "{\"event\":\"");
+        p = gc_report_put(p, event);
+        if (node >= 0) {
+            p = gc_report_put(p, "\",\"node\":");
+            p = gc_report_put_number(p, (unsigned long)node);
+            p = gc_report_put(p, ",\"bytes\":");
+        } else {
+            p = gc_report_put(p, "\",\"bytes\":");
+        }
+        p = gc_report_put_number(p, (unsigned long)bytes);
+        p = gc_report_put(p, "}\n");
+        gc_report.used = p - gc_report.buffer;
+        gc_report.records++;
+    }
+    return false;
+}
+
+// Function to check whether element-by-element printouts are wanted
+inline bool gc_report_verbose() {
+    return gc_report.mode == GC_REPORT_VERBOSE;
+}
+
+// Function to select the report mode; 'path' names the NDJSON output. Returns 0 on success
+inline int gc_report_set(int mode, const char* path) {
+    static bool registered = false;
+    gc_report_close();
+    if (mode == GC_REPORT_NDJSON) {
+        gc_report.file = fopen(path, "w");
+        if (gc_report.file == NULL)
+            return -1;
+        gc_report.buffer = (char*)malloc(GC_REPORT_BUFFER);
+        gc_report.used = 0;
+        if (!registered) {
+            atexit(gc_report_close);
+            registered = true;
+        }
+    }
+    gc_report.mode = mode;
+    return 0;
+}
+
+// Function to select the report mode from GC_REPORT: unset or "verbose", "summary" or "ndjson:<path>"
+inline void gc_report_from_env() {
+    const char* spec = getenv("GC_REPORT");
+    if (spec == NULL || strcmp(spec, "verbose") == 0)
+        return;
+    if (strcmp(spec, "summary") == 0) {
+        gc_report_set(GC_REPORT_SUMMARY, NULL);
+    } else if (strncmp(spec, "ndjson:", 7) == 0) {
+        if (gc_report_set(GC_REPORT_NDJSON, spec + 7) != 0)
+            fprintf(stderr, "Error: Unable to write garbage report %s\n", spec + 7);
+    } else {
+        fprintf(stderr, "Error: Unknown GC_REPORT %s, expected verbose, summary or ndjson:<path>\n", spec);
+    }
+}
+
+#endif
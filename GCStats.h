@@ -0,0 +1,215 @@
+#ifndef GCSTATS_H
+#define GCSTATS_H
+
+// Collector statistics: per-phase timings of every collection, objects and bytes visited and
+// freed, the mark stack high-water mark and the allocator's free-list length. They are only
+// compiled in with -DGC_STATS; otherwise every GC_STATS_* hook expands to nothing, so the
+// collectors' hot paths are the same as without them. A snapshot can be copied at any time and
+// can also be dumped to a file every few collections, as NDJSON lines or Prometheus text
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+// Phases of a collection
+enum { GC_PHASE_ROOTS, GC_PHASE_MARK, GC_PHASE_SWEEP, GC_PHASE_COALESCE, GC_NUM_PHASES };
+
+// Formats of the periodic dump
+enum { GC_STATS_JSON, GC_STATS_PROMETHEUS };
+
+// Structure to represent a snapshot of the statistics
+typedef struct {
+    uint64_t collections;
+    double phase_seconds[GC_NUM_PHASES]; // summed over every collection
+    double last_phase_seconds[GC_NUM_PHASES]; // of the latest collection only
+    uint64_t objects_visited;
+    uint64_t bytes_visited;
+    uint64_t objects_freed;
+    uint64_t bytes_freed;
+    long mark_stack_high_water; // deepest mark stack seen by any collection
+    long free_list_length; // free blocks in the allocator when the latest collection ended
+    long last_objects_freed; // objects the latest collection reclaimed
+} GCStats;
+
+// Live statistics and the state of the open phase and of the periodic dump
+inline GCStats gc_stats;
+inline int gc_stats_phase = -1;
+inline double gc_stats_phase_start = 0.0;
+inline uint64_t gc_stats_freed_at_begin = 0; // objects_freed when the open collection began
+inline const char* gc_stats_dump_path = NULL;
+inline int gc_stats_dump_format = GC_STATS_JSON;
+inline int gc_stats_dump_every = 1;
+
+inline const char* gc_phase_names[GC_NUM_PHASES] = {"roots", "mark", "sweep", "coalesce"};
+
+// Function to read the monotonic clock in seconds
+inline double gc_stats_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to close the open phase, charging its time to the totals and to the latest collection
+inline void gc_stats_end_phase() {
+    if (gc_stats_phase < 0)
+        return;
+    double seconds = gc_stats_now() - gc_stats_phase_start;
+    gc_stats.phase_seconds[gc_stats_phase] += seconds;
+    gc_stats.last_phase_seconds[gc_stats_phase] += seconds;
+    gc_stats_phase = -1;
+}
+
+// Function to close the open phase, if any, and start timing 'phase'
+inline void gc_stats_begin_phase(int phase) {
+    gc_stats_end_phase();
+    gc_stats_phase = phase;
+    gc_stats_phase_start = gc_stats_now();
+}
+
+// Function to start timing 'phase' only if no other phase is open, for work such as a lazy
+// sweep step that may run inside another timed phase. Returns whether it started the phase
+inline bool gc_stats_begin_phase_if_idle(int phase) {
+    if (gc_stats_phase >= 0)
+        return false;
+    gc_stats_begin_phase(phase);
+    return true;
+}
+
+// Function to start a collection, clearing the per-collection timings
+inline void gc_stats_begin_collection() {
+    gc_stats_end_phase();
+    memset(gc_stats.last_phase_seconds, 0, sizeof(gc_stats.last_phase_seconds));
+    gc_stats_freed_at_begin = gc_stats.objects_freed;
+}
+
+// Function to copy the current statistics
+inline GCStats gc_stats_snapshot() {
+    return gc_stats;
+}
+
+// Function to clear the statistics
+inline void gc_stats_reset() {
+    memset(&gc_stats, 0, sizeof(GCStats));
+    gc_stats_phase = -1;
+    gc_stats_freed_at_begin = 0;
+}
+
+// Function to write a snapshot as one line of JSON
+inline void gc_stats_write_json(FILE* out, const GCStats* s) {
+    fprintf(out, "{\"collections\":%llu", (unsigned long long)s->collections);
+    for (int pass = 0; pass < 2; pass++) {
+        const double* seconds = pass ? s->last_phase_seconds : s->phase_seconds;
+        fprintf(out, ",\"%s\":{", pass ? "last_phase_seconds" : "phase_seconds");
+        for (int p = 0; p < GC_NUM_PHASES; p++)
+            fprintf(out, "%s\"%s\":%.9f", p ? "," : "", gc_phase_names[p], seconds[p]);
+        fputc('}', out);
+    }
+    fprintf(out, ",\"objects_visited\":%llu,\"bytes_visited\":%llu,\"objects_freed\":%llu,\"bytes_freed\":%llu",
+            (unsigned long long)s->objects_visited, (unsigned long long)s->bytes_visited,
+            (unsigned long long)s->objects_freed, (unsigned long long)s->bytes_freed);
+    fprintf(out, ",\"mark_stack_high_water\":%ld,\"free_list_length\":%ld,\"last_objects_freed\":%ld}\n",
+            s->mark_stack_high_water, s->free_list_length, s->last_objects_freed);
+}
+
+// Function to write a snapshot in the Prometheus text exposition format
+inline void gc_stats_write_prometheus(FILE* out, const GCStats* s) {
+    fprintf(out, "# HELP gc_collections_total Collections completed.\n# TYPE gc_collections_total counter\n");
+    fprintf(out, "gc_collections_total %llu\n", (unsigned long long)s->collections);
+    fprintf(out, "# HELP gc_phase_seconds_total Time spent in each collection phase.\n"
+                 "# TYPE gc_phase_seconds_total counter\n");
+    for (int p = 0; p < GC_NUM_PHASES; p++)
+        fprintf(out, "gc_phase_seconds_total{phase=\"%s\"} %.9f\n", gc_phase_names[p], s->phase_seconds[p]);
+    fprintf(out, "# HELP gc_last_phase_seconds Time spent in each phase by the latest collection.\n"
+                 "# TYPE gc_last_phase_seconds gauge\n");
+    for (int p = 0; p < GC_NUM_PHASES; p++)
+        fprintf(out, "gc_last_phase_seconds{phase=\"%s\"} %.9f\n", gc_phase_names[p], s->last_phase_seconds[p]);
+    const char* counters[] = {"objects_visited", "bytes_visited", "objects_freed", "bytes_freed"};
+    uint64_t values[] = {s->objects_visited, s->bytes_visited, s->objects_freed, s->bytes_freed};
+    for (int c = 0; c < 4; c++) {
+        fprintf(out, "# TYPE gc_%s_total counter\ngc_%s_total %llu\n", counters[c], counters[c],
+                (unsigned long long)values[c]);
+    }
+    fprintf(out, "# TYPE gc_mark_stack_high_water gauge\ngc_mark_stack_high_water %ld\n", s->mark_stack_high_water);
+    fprintf(out, "# TYPE gc_free_list_length gauge\ngc_free_list_length %ld\n", s->free_list_length);
+    fprintf(out, "# TYPE gc_last_objects_freed gauge\ngc_last_objects_freed %ld\n", s->last_objects_freed);
+}
+
+// Function to dump the statistics to the configured file: JSON appends one line per dump,
+// Prometheus text replaces the file through a rename so a scraper never reads half of it
+inline void gc_stats_dump() {
+    if (gc_stats_dump_path == NULL)
+        return;
+    if (gc_stats_dump_format == GC_STATS_JSON) {
+        FILE* out = fopen(gc_stats_dump_path, "a");
+        if (out) {
+            gc_stats_write_json(out, &gc_stats);
+            fclose(out);
+        }
+        return;
+    }
+    char tmp[4096];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", gc_stats_dump_path);
+    FILE* out = fopen(tmp, "w");
+    if (out == NULL)
+        return;
+    gc_stats_write_prometheus(out, &gc_stats);
+    if (fclose(out) == 0)
+        rename(tmp, gc_stats_dump_path);
+}
+
+// Function to dump the statistics to 'path' after every 'every' collections
+inline void gc_stats_set_dump(const char* path, int format, int every) {
+    gc_stats_dump_path = path;
+    gc_stats_dump_format = format;
+    gc_stats_dump_every = every > 0 ? every : 1;
+}
+
+// Function to configure the dump from GC_STATS_FILE, GC_STATS_FORMAT ("json" or "prometheus")
+// and GC_STATS_EVERY
+inline void gc_stats_dump_from_env() {
+    const char* path = getenv("GC_STATS_FILE");
+    if (path == NULL)
+        return;
+    const char* format = getenv("GC_STATS_FORMAT");
+    const char* every = getenv("GC_STATS_EVERY");
+    gc_stats_set_dump(path, format && strcmp(format, "prometheus") == 0 ? GC_STATS_PROMETHEUS : GC_STATS_JSON,
+                      every ? atoi(every) : 1);
+}
+
+// Function to finish a collection, recording the free-list length and dumping if one is due
+inline void gc_stats_end_collection(long free_list_length) {
+    gc_stats_end_phase();
+    gc_stats.collections++;
+    gc_stats.free_list_length = free_list_length;
+    gc_stats.last_objects_freed = (long)(gc_stats.objects_freed - gc_stats_freed_at_begin);
+    if (gc_stats.collections % gc_stats_dump_every == 0)
+        gc_stats_dump();
+}
+
+#ifdef GC_STATS
+#define GC_STATS_BEGIN_COLLECTION() gc_stats_begin_collection()
+#define GC_STATS_PHASE(phase) gc_stats_begin_phase(phase)
+#define GC_STATS_PHASE_IF_IDLE(phase) gc_stats_begin_phase_if_idle(phase)
+#define GC_STATS_END_PHASE() gc_stats_end_phase()
+#define GC_STATS_END_COLLECTION(free_list_length) gc_stats_end_collection(free_list_length)
+#define GC_STATS_VISIT(objects, bytes) (gc_stats.objects_visited += (objects), gc_stats.bytes_visited += (bytes))
+#define GC_STATS_FREE(objects, bytes) (gc_stats.objects_freed += (objects), gc_stats.bytes_freed += (bytes))
+#define GC_STATS_MARK_STACK(depth) \
+    (gc_stats.mark_stack_high_water = (depth) > gc_stats.mark_stack_high_water ? (depth) : gc_stats.mark_stack_high_water)
+#define GC_STATS_DUMP_FROM_ENV() gc_stats_dump_from_env()
+#define GC_STATS_DUMP() gc_stats_dump()
+#else
+#define GC_STATS_BEGIN_COLLECTION() ((void)0)
+#define GC_STATS_PHASE(phase) ((void)0)
+#define GC_STATS_PHASE_IF_IDLE(phase) false
+#define GC_STATS_END_PHASE() ((void)0)
+#define GC_STATS_END_COLLECTION(free_list_length) ((void)0)
+#define GC_STATS_VISIT(objects, bytes) ((void)0)
+#define GC_STATS_FREE(objects, bytes) ((void)0)
+#define GC_STATS_MARK_STACK(depth) ((void)0)
+#define GC_STATS_DUMP_FROM_ENV() ((void)0)
+#define GC_STATS_DUMP() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef GRAPHGEN_H
+#define GRAPHGEN_H
+
+// Seeded synthetic heap graphs for scale runs. Vertex 0 is the root; the first
+// (1 - garbage fraction) of the vertices are live and every one of them is reachable from it
+// through a shape-specific spine, the rest are garbage that live vertices never point to.
+// Edges are produced in fixed blocks whose generator state depends only on the seed and the
+// block index, so a spec yields the same edges whatever the number of threads
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <thread>
+#include "Trace.h"
+#define GEN_BLOCK_EDGES (1 << 16)
+
+// Graph shapes the generator can produce
+enum {
+    GEN_RANDOM, // Erdos-Renyi: endpoints chosen uniformly
+    GEN_POWER_LAW, // skewed in-degree, low vertex ids attract most edges
+    GEN_LISTS, // linked lists of 'param' vertices hanging off the root
+    GEN_TREE, // a tree with fan-out 'param'
+    GEN_CLUSTERS, // rings of 'param' vertices with dense edges inside each ring
+    GEN_MIX // the vertex range split evenly between the five shapes above
+};
+
+// Structure to describe a graph to generate
+typedef struct {
+    int shape;
+    int numVertices;
+    long numEdges; // raised to the spine's numLive - 1 edges if smaller
+    double garbageFraction; // share of the vertices unreachable from the root
+    int param; // list length, tree fan-out or cluster size, by shape
+    uint64_t seed;
+    int numThreads;
+} GenSpec;
+
+// Structure to represent a generated edge list, edge e is src[e] -> dest[e]
+typedef struct {
+    int* src;
+    int* dest;
+    long numEdges;
+    int numVertices;
+    int numLive;
+} EdgeList;
+
+// SplitMix64, one independent stream per block of edges
+inline uint64_t gen_next(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Function to draw a uniform integer in [0, n)
+inline int gen_below(uint64_t* state, int n) {
+    return (int)(((gen_next(state) >> 32) * (uint64_t)n) >> 32);
+}
+
+// Function to find the shape a vertex follows, which only varies in GEN_MIX graphs
+inline int gen_shape_of(const GenSpec* spec, int numLive, int vertex) {
+    if (spec->shape != GEN_MIX)
+        return spec->shape;
+    if (vertex >= numLive)
+        return GEN_RANDOM;
+    return (int)((int64_t)vertex * GEN_MIX / numLive);
+}
+
+// Function to pick the spine parent of live vertex 'v' (v >= 1), which is always a smaller id
+inline int gen_spine_src(const GenSpec* spec, int numLive, int v, uint64_t* state) {
+    int param = spec->param > 1 ? spec->param : 2;
+    switch (gen_shape_of(spec, numLive, v)) {
+    case GEN_LISTS:
+        return v % param == 0 ? 0 : v - 1;
+    case GEN_TREE:
+        return (v - 1) / param;
+    case GEN_CLUSTERS:
+        return v % param == 0 ? gen_below(state, v) : v - 1;
+    default:
+        return gen_below(state, v);
+    }
+}
+
+// Function to pick the target of an extra edge out of 'src'; live sources stay in the live range
+inline int gen_extra_dest(const GenSpec* spec, int numLive, int src, uint64_t* state) {
+    int limit = src < numLive ? numLive : spec->numVertices;
+    int param = spec->param > 1 ? spec->param : 2;
+    int base, span;
+    switch (gen_shape_of(spec, numLive, src)) {
+    case GEN_POWER_LAW: {
+        double u = (gen_next(state) >> 11) * (1.0 / 9007199254740992.0);
+        return (int)(u * u * u * limit);
+    }
+    case GEN_LISTS:
+    case GEN_CLUSTERS:
+        // Stay inside the source's own list or ring
+        base = src - src % param;
+        span = base + param < limit ? param : limit - base;
+        return base + gen_below(state, span);
+    default:
+        return gen_below(state, limit);
+    }
+}
+
+// Function to fill edges [first, last): spine edges come first, then extra edges
+inline void gen_fill(const GenSpec* spec, EdgeList* edges, long first, long last) {
+    long spine = edges->numLive - 1;
+    for (long block = first / GEN_BLOCK_EDGES; block * GEN_BLOCK_EDGES < last; block++) {
+        uint64_t state = spec->seed ^ ((uint64_t)block * 0xD1B54A32D192ED03ull);
+        long end = (block + 1) * GEN_BLOCK_EDGES < last ? (block + 1) * GEN_BLOCK_EDGES : last;
+        for (long e = block * GEN_BLOCK_EDGES; e < end; e++) {
+            if (e < spine) {
+                int v = (int)(e + 1);
+                edges->src[e] = gen_spine_src(spec, edges->numLive, v, &state);
+                edges->dest[e] = v;
+            } else {
+                int src = gen_below(&state, spec->numVertices);
+                edges->src[e] = src;
+                edges->dest[e] = gen_extra_dest(spec, edges->numLive, src, &state);
+            }
+        }
+    }
+}
+
+// Function to generate the edges of 'spec' on spec->numThreads threads
+inline EdgeList* generate_edges(const GenSpec* spec) {
+    EdgeList* edges = (EdgeList*)malloc(sizeof(EdgeList));
+    edges->numVertices = spec->numVertices;
+    edges->numLive = spec->numVertices - (int)(spec->garbageFraction * spec->numVertices);
+    if (edges->numLive < 1)
+        edges->numLive = 1;
+    edges->numEdges = spec->numEdges > edges->numLive - 1 ? spec->numEdges : edges->numLive - 1;
+    edges->src = (int*)malloc(edges->numEdges * sizeof(int));
+    edges->dest = (int*)malloc(edges->numEdges * sizeof(int));
+
+    // Threads take whole blocks so the output does not depend on the thread count
+    int numThreads = spec->numThreads > 0 ? spec->numThreads : 1;
+    long numBlocks = (edges->numEdges + GEN_BLOCK_EDGES - 1) / GEN_BLOCK_EDGES;
+    std::thread* workers = new std::thread[numThreads];
+    for (int t = 0; t < numThreads; t++) {
+        long first = numBlocks * t / numThreads * GEN_BLOCK_EDGES;
+        long last = numBlocks * (t + 1) / numThreads * GEN_BLOCK_EDGES;
+        if (last > edges->numEdges)
+            last = edges->numEdges;
+        workers[t] = std::thread(gen_fill, spec, edges, first, last);
+    }
+    for (int t = 0; t < numThreads; t++)
+        workers[t].join();
+    delete[] workers;
+    return edges;
+}
+
+// Function to free a generated edge list
+inline void free_edges(EdgeList* edges) {
+    free(edges->src);
+    free(edges->dest);
+    free(edges);
+}
+
+// Function to write an edge list as a heap trace: every vertex is allocated with 'objectSize'
+// bytes, vertex 0 becomes the root and each edge is a store into the next field of its source.
+// A vertex with more out-edges than TRACE_MAX_SLOTS overwrites its oldest fields, which turns
+// the trace into churn. Returns 0 on success
+inline int write_edges_trace(const EdgeList* edges, uint32_t objectSize, const char* path) {
+    TraceWriter* writer = trace_open_writer(path, (uint32_t)edges->numVertices);
+    if (writer == NULL)
+        return -1;
+    for (int v = 0; v < edges->numVertices; v++)
+        trace_write(writer, TRACE_ALLOC, v, objectSize, 0);
+    trace_write(writer, TRACE_ROOT_ADD, 0, 0, 0);
+    unsigned char* nextSlot = (unsigned char*)calloc(edges->numVertices, 1);
+    for (long e = 0; e < edges->numEdges; e++) {
+        int src = edges->src[e];
+        trace_write(writer, TRACE_STORE, src, edges->dest[e], nextSlot[src]);
+        nextSlot[src] = (nextSlot[src] + 1) % TRACE_MAX_SLOTS;
+    }
+    free(nextSlot);
+    return trace_close_writer(writer);
+}
+
+#endif
@@ -1,150 +1,54 @@
-#include <stdio.h>
-#include <stdlib.h>
-#define MAX_NODES 100
+#include "MarkNSweep.h"
 
-// Structure to represent the heap
-typedef struct {
-    int adjacency_matrix[MAX_NODES][MAX_NODES];
-    int node_count;
-} Heap;
+using namespace marknsweep;
 
-// Define structure for a node in adjacency list
-typedef struct Node {
-    int data;
-    struct Node* next;
-    int marked;
-} Node;
-
-// Define structure for adjacency list
-typedef struct {
-    Node** array;
-    int numVertices;
-} Graph;
-
-// Function to create a new node
-Node* createNode(int data) {
-    Node* newNode = (Node*)malloc(sizeof(Node));
-    newNode->data = data;
-    newNode->next = NULL;
-    return newNode;
-}
-
-// Function to create a graph with 'numVertices' vertices
-Graph* createGraph(int numVertices) {
-    Graph* graph = (Graph*)malloc(sizeof(Graph));
-    graph->numVertices = numVertices;
-    graph->array = (Node**)malloc(numVertices * sizeof(Node*));
-    for (int i = 0; i < numVertices; ++i)
-        graph->array[i] = NULL;
-    return graph;
-}
-
-// Function to add an edge to an undirected graph
-void addEdge(Graph* graph, int src, int dest) {
-    Node* newNode = createNode(dest);
-    newNode->next = graph->array[src];
-    graph->array[src] = newNode;
-}
-
-// Function to convert adjacency list to adjacency matrix
-void adjacency_list_to_matrix(Graph* graph, int adj_matrix[][MAX_NODES]) {
-    for (int i = 0; i < graph->numVertices; i++) {
-        Node* temp = graph->array[i];
-        while (temp) {
-            adj_matrix[i][temp->data] = 1;
-            temp = temp->next;
-        }
-    }
-    
-}
-
-// Function to print adjacency matrix
-void print_adjacency_matrix(int adj_matrix[][MAX_NODES], int n_nodes) {
+// Function to print adjacency matrix, expanding one row at a time from the adjacency list
+void print_adjacency_matrix(Graph* graph, int n_nodes) {
+    if (!gc_report_verbose())
+        return;
     printf("Adjacency Matrix:\n");
+    int* row = (int*)malloc((n_nodes > 0 ? n_nodes : 1) * sizeof(int));
     for (int i = 0; i < n_nodes; i++) {
     		if(i!=0 && i!=4 && i!=6){
+        memset(row, 0, n_nodes * sizeof(int));
+        for (Node* temp = graph->array[i]; temp; temp = temp->next)
+            row[temp->data] = 1;
         for (int j = 0; j < n_nodes; j++) {
         		if(j!=0 && j!=4 && j!=6){
-            printf("%d ", adj_matrix[i][j]);
+            printf("%d ", row[j]);
         }}
 		 printf("\n");}
     }
+    free(row);
 }
 
-// Function to initialize the heap
-void initialize_heap(Heap *heap, int adjacency_matrix[MAX_NODES][MAX_NODES], int node_count) {
-    int i, j;
-    heap->node_count = node_count;
-    for (i = 0; i < node_count; i++) {
-        for (j = 0; j < node_count; j++) {
-            heap->adjacency_matrix[i][j] = adjacency_matrix[i][j];
-        }
-    }
-}
-
-// Function to perform depth-first search (DFS) recursively
-void DFS(Graph* graph, int vertex, bool* visited) {
-    // Mark the current vertex as visited
-    visited[vertex] = true;
-    // Traverse all adjacent vertices of the current vertex
-    Node* current = graph->array[vertex];
-    while (current != NULL) {
-        int adjacentVertex = current->data;
-        if (!visited[adjacentVertex]) {
-            // If the adjacent vertex is not visited, recursively call DFS
-            DFS(graph, adjacentVertex, visited);
-        }
-        current = current->next;
-    }
-}
-
-// Function to perform mark and sweep garbage collection
-void mark_and_sweep(Graph* graph) {
-    // Initialize the visited array
-    bool visited[MAX_NODES] = {false};
-
-    // Mark all reachable nodes starting from vertex 0
-    DFS(graph, 5, visited);
-	//the output of the mark and sweep may vary from one another depending on the starting vertex of the graph
-    printf("\nGarbage nodes:\n");
-    int sum = 0;
-    for (int i = 0; i < graph->numVertices; ++i) {
-    		if(i!=4 && i!=0 && i!=6){
-        if (!visited[i] && i!=5) {//as we are stating from the 5th node 
-            printf("Node value = %d, Memory freed = %d\n", i, (int)sizeof(Node));
-            free(graph->array[i]);
-            graph->array[i] = NULL;
-            sum += sizeof(Node);
-        }}
-    }
-    printf("Total memory freed = %d\n", sum);
-}
-
-void check(int adjacency_matrix[MAX_NODES][MAX_NODES],int n,Graph* graph){
-	printf("garbage elements: \n");
-	int sum=0;
+void check(Graph* graph){
+	if(gc_report_verbose())
+		printf("garbage elements: \n");
+	int sum=0, n=graph->numVertices;
+	// in-degrees come from one pass over the adjacency lists
+	int* in_degree=(int*)calloc(n, sizeof(int));
+	for(int j=0;j<n;j++){
+		for(Node* temp=graph->array[j];temp;temp=temp->next){
+			in_degree[temp->data]++;
+		}
+	}
 	for(int i=0;i<n;i++){
 		if(i!=4 && i!=0 && i!=6 && i!=5){
-		int j=0, flag=1;
-		while(j<n && flag==1){
-			if(adjacency_matrix[j][i]==0){
-				j++;
-			}
-			else{
-				flag=0;
-			}
-		}
-		if(flag==1){
+		if(in_degree[i]==0){
 			sum=sum+ sizeof(i)+sizeof(Node);
-            printf("node value=%d , memory freed=%d\n", i, sizeof(i)+sizeof(Node));
+            if (gc_report_object("garbage", i, sizeof(i) + sizeof(Node)))
+                printf("node value=%d , memory freed=%d\n", i, sizeof(i)+sizeof(Node));
 			free(graph->array[i]);
 			graph->array[i]=NULL;
-			n--;
 		}}}
+	free(in_degree);
 	printf("total memory freed=%d\n", sum);
 }
 
 void printAdj_list(Graph* graph){
+	if(!gc_report_verbose())
+		return;
 	int num=graph->numVertices;
 	for(int i=0;i<num;i++){
 		if(i!=0 && i!=4 && i!=6 ){
@@ -160,6 +64,8 @@ void printAdj_list(Graph* graph){
 }
 
 int main() {
+    gc_report_from_env();
+    GC_STATS_DUMP_FROM_ENV();
     int numVertices = 11;
     Graph* graph = createGraph(numVertices);
 
@@ -179,22 +85,40 @@ int main() {
     Node* root_2 = graph->array[1];
     
 	printf("MARK AND SWEEP\n");
-    // Initialize adjacency matrix with all zeros
-    int adj_matrix[MAX_NODES][MAX_NODES] = {0};
-
-    // Convert adjacency list to adjacency matrix
-    adjacency_list_to_matrix(graph, adj_matrix);
 	printf("the required Adjacent matrix is :\n");
     // Print adjacency matrix
-    print_adjacency_matrix(adj_matrix, numVertices);
+    print_adjacency_matrix(graph, numVertices);
 	printf("the required Adjacent list is :\n");
     printAdj_list(graph);
-    Heap heap;
-    initialize_heap(&heap, adj_matrix, numVertices);
+    CSRGraph* csr = graph_to_csr(graph);
     // Perform mark and sweep garbage collection
     printf("Applying mark and sweep on the given graph :\n");
     mark_and_sweep(graph);
+    printf("Applying mark and sweep on the CSR form of the graph :\n");
+    mark_and_sweep_csr(csr, 5);
+    int numThreads = (int)std::thread::hardware_concurrency();
+    printf("Parallel mark with %d thread%s matches the sequential mark: %s\n", numThreads,
+           numThreads == 1 ? "" : "s", parallel_mark_matches_dfs(csr, 5, numThreads) ? "yes" : "no");
+    freeCSRGraph(csr);
+    double maxPauseUs;
+    bool safe = incremental_mark_stress(1000, 100000, 64, 1, &maxPauseUs);
+    printf("Incremental mark under random mutation never frees a live vertex: %s (max pause %.1f us)\n",
+           safe ? "yes" : "no", maxPauseUs);
+    double baseOps, concurrentOps, maxRemarkUs;
+    int collections;
+    concurrent_mark_stress(1000, 200000, 1, false, false, &baseOps, &maxRemarkUs, &collections);
+    safe = concurrent_mark_stress(1000, 200000, 1, true, true, &concurrentOps, &maxRemarkUs, &collections);
+    safe = concurrent_mark_stress(1000, 200000, 1, true, false, &concurrentOps, &maxRemarkUs, &collections) && safe;
+    printf("Concurrent mark never frees a live vertex: %s (%d collections, max remark %.1f us, "
+           "mutator throughput %.0f%% of running alone)\n", safe ? "yes" : "no", collections,
+           maxRemarkUs, baseOps > 0 ? 100.0 * concurrentOps / baseOps : 0.0);
+    const char* shapes[] = {"random", "power-law", "lists", "tree", "clusters", "mix"};
+    for (int shape = GEN_RANDOM; shape <= GEN_MIX; shape++) {
+        GenSpec spec = {shape, 100000, 400000, 0.1, 16, 42, numThreads};
+        printf("Generated %s graph marks exactly its live vertices: %s\n", shapes[shape],
+               generated_graph_marks_live(&spec) ? "yes" : "no");
+    }
 	// DFS_print_unreachable(graph,5);
-    //check(adj_matrix, numVertices,graph);
+    //check(graph);
     return 0;
 }
@@ -0,0 +1,772 @@
+#ifndef MARKNSWEEP_H
+#define MARKNSWEEP_H
+
+// Mark-and-sweep collectors over adjacency-list graphs: recursive, iterative with a bounded mark
+// stack, incremental with a write barrier, CSR with a parallel work-stealing marker, and a
+// concurrent collector with a snapshot-at-the-beginning barrier. Everything is declared in
+// namespace marknsweep so MarkNSweep.cpp and GCBench.cpp can both include it next to the other
+// collectors; the graph types, CSR form and bitmap marker come from GCCore.h
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "GraphGen.h"
+#include "GCStats.h"
+#include "GCReport.h"
+#include "GCCore.h"
+#define LIST_LOCK_STRIPES 64 // adjacency lists guarded by each lock of the concurrent collector
+#define PARALLEL_MARK_BATCH 64 // successors a parallel marking thread counts with one atomic add
+#define PARALLEL_CHECK_THREADS 4 // marking threads of the generated-graph self-check
+
+namespace marknsweep {
+
+using namespace gccore;
+
+// Define structure for an incremental tri-color marker: a vertex is white while unmarked,
+// gray while it is marked and waiting on the gray stack, and black once its list is scanned
+typedef struct {
+    Graph* graph;
+    MarkBitmap* marks;
+    int* gray;
+    int grayTop;
+    Node* scanning; // next node of the vertex being blackened, NULL between vertices
+    bool active;
+    double maxPauseUs;
+} IncrementalMarker;
+
+// Function to create a new node
+inline Node* createNode(int data) {
+    Node* newNode = (Node*)malloc(sizeof(Node));
+    newNode->data = data;
+    newNode->next = NULL;
+    return newNode;
+}
+
+// Function to create a graph with 'numVertices' vertices
+inline Graph* createGraph(int numVertices) {
+    Graph* graph = (Graph*)malloc(sizeof(Graph));
+    graph->numVertices = numVertices;
+    graph->array = (Node**)malloc(numVertices * sizeof(Node*));
+    for (int i = 0; i < numVertices; ++i)
+        graph->array[i] = NULL;
+    return graph;
+}
+
+inline void incremental_barrier(Graph* graph, int dest);
+
+// Function to add an edge to an undirected graph
+inline void addEdge(Graph* graph, int src, int dest) {
+    Node* newNode = createNode(dest);
+    newNode->next = graph->array[src];
+    graph->array[src] = newNode;
+    incremental_barrier(graph, dest);
+}
+
+// The marker whose collection is in progress, consulted by the write barrier
+inline IncrementalMarker* active_marker = NULL;
+
+// Function to turn a white vertex gray
+inline void shade(IncrementalMarker* m, int vertex) {
+    if (!is_marked(m->marks, vertex)) {
+        set_mark(m->marks, vertex);
+        m->gray[m->grayTop++] = vertex;
+    }
+}
+
+// Dijkstra write barrier: while marking is in progress every stored edge shades its target,
+// so a black vertex can never point at a white one
+inline void incremental_barrier(Graph* graph, int dest) {
+    if (active_marker && active_marker->graph == graph)
+        shade(active_marker, dest);
+}
+
+// Function to start an incremental collection of 'graph' from 'root'
+inline IncrementalMarker* incremental_mark_begin(Graph* graph, int root) {
+    IncrementalMarker* m = (IncrementalMarker*)malloc(sizeof(IncrementalMarker));
+    m->graph = graph;
+    m->marks = createMarkBitmap(graph->numVertices);
+    // Every vertex is shaded at most once, so the gray stack never holds more than numVertices
+    m->gray = (int*)malloc(graph->numVertices * sizeof(int));
+    m->grayTop = 0;
+    m->scanning = NULL;
+    m->active = true;
+    m->maxPauseUs = 0.0;
+    shade(m, root);
+    active_marker = m;
+    return m;
+}
+
+// Function to do at most 'budget' units of marking work, one unit per vertex popped or edge
+// scanned. Returns true once the gray stack is empty and marking is complete
+inline bool incremental_mark_step(IncrementalMarker* m, int budget) {
+    if (!m->active)
+        return true;
+    auto start = std::chrono::steady_clock::now();
+    while (budget-- > 0) {
+        if (m->scanning == NULL) {
+            if (m->grayTop == 0) {
+                m->active = false;
+                if (active_marker == m)
+                    active_marker = NULL;
+                break;
+            }
+            m->scanning = m->graph->array[m->gray[--m->grayTop]];
+            continue;
+        }
+        shade(m, m->scanning->data);
+        m->scanning = m->scanning->next;
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    if (us > m->maxPauseUs)
+        m->maxPauseUs = us;
+    return !m->active;
+}
+
+// Function to free an incremental marker
+inline void freeIncrementalMarker(IncrementalMarker* m) {
+    if (active_marker == m)
+        active_marker = NULL;
+    freeMarkBitmap(m->marks);
+    free(m->gray);
+    free(m);
+}
+
+// Function to remove the edge src -> dest, keeping the marker's scan position valid
+inline void removeEdge(Graph* graph, int src, int dest) {
+    Node** link = &graph->array[src];
+    while (*link && (*link)->data != dest)
+        link = &(*link)->next;
+    Node* victim = *link;
+    if (victim == NULL)
+        return;
+    if (active_marker && active_marker->scanning == victim)
+        active_marker->scanning = victim->next;
+    *link = victim->next;
+    free(victim);
+}
+
+// Function to randomly interleave edge insertions and deletions with incremental mark steps
+// of 'budget' units. Each time marking completes, every vertex reachable from vertex 0 must be
+// marked before the unmarked lists are freed. Returns false if a live vertex would be freed
+inline bool incremental_mark_stress(int numVertices, int numOps, int budget, unsigned seed, double* maxPauseUs) {
+    srand(seed);
+    Graph* graph = createGraph(numVertices);
+    for (int e = 0; e < 2 * numVertices; e++)
+        addEdge(graph, rand() % numVertices, rand() % numVertices);
+    MarkBitmap* reachable = createMarkBitmap(numVertices);
+    IncrementalMarker* m = incremental_mark_begin(graph, 0);
+    bool ok = true;
+    *maxPauseUs = 0.0;
+    for (int op = 0; op < numOps && ok; op++) {
+        int src = rand() % numVertices;
+        int dest = rand() % numVertices;
+        if (rand() % 3 == 0) {
+            if (graph->array[src])
+                removeEdge(graph, src, graph->array[src]->data);
+        } else {
+            addEdge(graph, src, dest);
+        }
+        if (!incremental_mark_step(m, budget))
+            continue;
+
+        clearMarkBitmap(reachable);
+        DFS_iterative(graph, 0, reachable);
+        for (int w = 0; w < reachable->numWords; w++) {
+            if (reachable->words[w] & ~m->marks->words[w])
+                ok = false;
+        }
+        // Sweep the white lists
+        for (int i = next_unmarked(m->marks, 0); i >= 0; i = next_unmarked(m->marks, i + 1)) {
+            while (graph->array[i])
+                removeEdge(graph, i, graph->array[i]->data);
+        }
+        if (m->maxPauseUs > *maxPauseUs)
+            *maxPauseUs = m->maxPauseUs;
+        freeIncrementalMarker(m);
+        m = incremental_mark_begin(graph, 0);
+    }
+    freeIncrementalMarker(m);
+    freeMarkBitmap(reachable);
+    for (int i = 0; i < numVertices; i++)
+        while (graph->array[i])
+            removeEdge(graph, i, graph->array[i]->data);
+    free(graph->array);
+    free(graph);
+    return ok;
+}
+
+// Function to perform mark and sweep garbage collection
+inline void mark_and_sweep(Graph* graph) {
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    // Clear the side mark bitmap
+    MarkBitmap* marks = collector_bitmap(graph->numVertices);
+
+    // Mark all reachable nodes starting from vertex 5
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    DFS_iterative(graph, 5, marks);
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+	//the output of the mark and sweep may vary from one another depending on the starting vertex of the graph
+    if (gc_report_verbose())
+        printf("\nGarbage nodes:\n");
+    int sum = 0;
+    // Walk the garbage by finding zero bits in the bitmap
+    for (int i = next_unmarked(marks, 0); i >= 0; i = next_unmarked(marks, i + 1)) {
+    		if(i!=4 && i!=0 && i!=6){
+        if (i!=5) {//as we are stating from the 5th node 
+            if (gc_report_object("garbage", i, sizeof(Node)))
+                printf("Node value = %d, Memory freed = %d\n", i, (int)sizeof(Node));
+            free(graph->array[i]);
+            graph->array[i] = NULL;
+            sum += sizeof(Node);
+            GC_STATS_FREE(1, sizeof(Node));
+        }}
+    }
+    // Nodes go back to malloc, there is no free list of our own to report
+    GC_STATS_END_COLLECTION(0);
+    printf("Total memory freed = %d\n", sum);
+}
+
+// Function to perform depth-first search (DFS) over a CSR graph with the explicit mark stack
+inline void DFS_csr(CSRGraph* csr, int vertex, MarkBitmap* marks) {
+    mark_stack_top = 0;
+    mark_stack_overflowed = false;
+    mark_push(vertex, marks);
+    while (mark_stack_top > 0 || mark_stack_overflowed) {
+        while (mark_stack_top > 0) {
+            int v = mark_stack[--mark_stack_top];
+            GC_STATS_VISIT(0, (csr->offsets[v + 1] - csr->offsets[v]) * sizeof(int));
+            for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+                if (!is_marked(marks, csr->targets[e]))
+                    mark_push(csr->targets[e], marks);
+            }
+        }
+        if (mark_stack_overflowed) {
+            mark_stack_overflowed = false;
+            for (int v = 0; v < csr->numVertices; v++) {
+                if (!is_marked(marks, v))
+                    continue;
+                for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+                    if (!is_marked(marks, csr->targets[e]))
+                        mark_push(csr->targets[e], marks);
+                }
+            }
+        }
+    }
+}
+
+// Function to perform mark and sweep garbage collection directly on a CSR graph
+// Vertices without edges own no storage in CSR form and are not reported. Each garbage vertex
+// is accounted as one Node, as mark_and_sweep() does, so both forms of a graph report the same totals
+inline int mark_and_sweep_csr(CSRGraph* csr, int root) {
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    MarkBitmap* marks = collector_bitmap(csr->numVertices);
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    DFS_csr(csr, root, marks);
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+    if (gc_report_verbose())
+        printf("\nGarbage nodes:\n");
+    int sum = 0, garbage = 0;
+    for (int i = next_unmarked(marks, 0); i >= 0; i = next_unmarked(marks, i + 1)) {
+        int degree = csr->offsets[i + 1] - csr->offsets[i];
+        if (degree > 0) {
+            if (gc_report_object("garbage", i, sizeof(Node)))
+                printf("Node value = %d, Memory freed = %d\n", i, (int)sizeof(Node));
+            sum += sizeof(Node);
+            garbage++;
+            GC_STATS_FREE(1, sizeof(Node));
+        }
+    }
+    GC_STATS_END_COLLECTION(0);
+    printf("Total memory freed = %d\n", sum);
+    return garbage;
+}
+
+// Circular array of a work deque. A full array is replaced by one twice its size; the old one
+// is kept on the 'older' chain until the mark ends, since a thief may still be reading it
+typedef struct DequeArray {
+    long capacity; // a power of two
+    std::atomic<int>* items;
+    struct DequeArray* older;
+} DequeArray;
+
+// Per-thread work deque for the parallel marker, after Chase and Lev: the owner pushes and pops
+// at 'bottom' without locking and thieves take the oldest entries from 'top' with a CAS, which
+// only contends with the owner when one entry is left
+typedef struct {
+    std::atomic<long> top;
+    std::atomic<long> bottom;
+    std::atomic<DequeArray*> array;
+} WorkDeque;
+
+// Function to allocate an empty deque array of 'capacity' slots
+inline DequeArray* deque_array(long capacity, DequeArray* older) {
+    DequeArray* a = (DequeArray*)malloc(sizeof(DequeArray));
+    a->capacity = capacity;
+    a->items = new std::atomic<int>[capacity];
+    a->older = older;
+    return a;
+}
+
+// Function to push a vertex on the owner end of a deque, called by the owner only
+inline void deque_push(WorkDeque* dq, int vertex) {
+    long b = dq->bottom.load(std::memory_order_relaxed);
+    long t = dq->top.load(std::memory_order_acquire);
+    DequeArray* a = dq->array.load(std::memory_order_relaxed);
+    if (b - t >= a->capacity) {
+        DequeArray* grown = deque_array(a->capacity * 2, a);
+        for (long i = t; i < b; i++)
+            grown->items[i & (grown->capacity - 1)].store(a->items[i & (a->capacity - 1)].load(std::memory_order_relaxed),
+                                                          std::memory_order_relaxed);
+        dq->array.store(grown, std::memory_order_release);
+        a = grown;
+    }
+    a->items[b & (a->capacity - 1)].store(vertex, std::memory_order_relaxed);
+    dq->bottom.store(b + 1, std::memory_order_release);
+}
+
+// Function to pop from the owner end of a deque, called by the owner only; -1 if empty
+inline int deque_pop(WorkDeque* dq) {
+    long b = dq->bottom.load(std::memory_order_relaxed) - 1;
+    DequeArray* a = dq->array.load(std::memory_order_relaxed);
+    dq->bottom.store(b, std::memory_order_seq_cst);
+    long t = dq->top.load(std::memory_order_seq_cst);
+    if (t > b) {
+        dq->bottom.store(b + 1, std::memory_order_relaxed);
+        return -1;
+    }
+    int vertex = a->items[b & (a->capacity - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // The last entry, race the thieves for it
+        if (!dq->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            vertex = -1;
+        dq->bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return vertex;
+}
+
+// Function to steal the oldest entry of another thread's deque; -1 if it is empty or another
+// thread took the entry first
+inline int deque_steal(WorkDeque* dq) {
+    long t = dq->top.load(std::memory_order_seq_cst);
+    long b = dq->bottom.load(std::memory_order_seq_cst);
+    if (t >= b)
+        return -1;
+    DequeArray* a = dq->array.load(std::memory_order_acquire);
+    int vertex = a->items[t & (a->capacity - 1)].load(std::memory_order_relaxed);
+    if (!dq->top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return -1;
+    return vertex;
+}
+
+// Function to atomically set a mark bit; returns true if this call set it
+inline bool mark_bit_test_and_set(uint64_t* bits, int vertex) {
+    uint64_t mask = (uint64_t)1 << (vertex & 63);
+    return (__atomic_fetch_or(&bits[vertex >> 6], mask, __ATOMIC_RELAXED) & mask) == 0;
+}
+
+// Function to count a batch of newly marked vertices as pending and push them. Counting them
+// before they can be stolen keeps 'pending' above zero until every one of them is scanned
+inline void push_batch(WorkDeque* dq, const int* batch, int count, std::atomic<long>* pending) {
+    pending->fetch_add(count, std::memory_order_relaxed);
+    for (int i = 0; i < count; i++)
+        deque_push(dq, batch[i]);
+}
+
+// Function run by each marking thread: drain the own deque, then steal from the others. Newly
+// marked successors are pushed PARALLEL_MARK_BATCH at a time, so a scan makes one shared update
+// per batch rather than one per edge
+inline void parallel_mark_worker(CSRGraph* csr, uint64_t* bits, WorkDeque* deques, int self,
+                                 int numThreads, std::atomic<long>* pending) {
+    int batch[PARALLEL_MARK_BATCH];
+    for (;;) {
+        int v = deque_pop(&deques[self]);
+        for (int k = 1; v < 0 && k < numThreads; k++)
+            v = deque_steal(&deques[(self + k) % numThreads]);
+        if (v < 0) {
+            // Every pushed vertex has been scanned once the pending count reaches zero
+            if (pending->load(std::memory_order_acquire) == 0)
+                return;
+            std::this_thread::yield();
+            continue;
+        }
+        int count = 0;
+        for (int e = csr->offsets[v]; e < csr->offsets[v + 1]; e++) {
+            int w = csr->targets[e];
+            if (mark_bit_test_and_set(bits, w)) {
+                batch[count++] = w;
+                if (count == PARALLEL_MARK_BATCH) {
+                    push_batch(&deques[self], batch, count, pending);
+                    count = 0;
+                }
+            }
+        }
+        if (count > 0)
+            push_batch(&deques[self], batch, count, pending);
+        pending->fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// Function to mark everything reachable from 'roots' using 'numThreads' work-stealing threads.
+// 'bits' is a zeroed bitmap of (numVertices + 63) / 64 words, bit v set means vertex v is live
+inline void parallel_mark_csr(CSRGraph* csr, const int* roots, int numRoots, int numThreads, uint64_t* bits) {
+    if (numThreads < 1)
+        numThreads = 1;
+    WorkDeque* deques = new WorkDeque[numThreads];
+    for (int t = 0; t < numThreads; t++) {
+        deques[t].top = 0;
+        deques[t].bottom = 0;
+        deques[t].array = deque_array(1024, NULL);
+    }
+    std::atomic<long> pending(0);
+    // Deal the roots out round-robin so every thread starts with work
+    for (int r = 0; r < numRoots; r++) {
+        if (mark_bit_test_and_set(bits, roots[r])) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            deque_push(&deques[r % numThreads], roots[r]);
+        }
+    }
+    std::thread* workers = new std::thread[numThreads];
+    for (int t = 0; t < numThreads; t++)
+        workers[t] = std::thread(parallel_mark_worker, csr, bits, deques, t, numThreads, &pending);
+    for (int t = 0; t < numThreads; t++)
+        workers[t].join();
+    delete[] workers;
+    for (int t = 0; t < numThreads; t++) {
+        DequeArray* a = deques[t].array.load();
+        while (a) {
+            DequeArray* older = a->older;
+            delete[] a->items;
+            free(a);
+            a = older;
+        }
+    }
+    delete[] deques;
+}
+
+// Function to check that the parallel marker reaches exactly the vertices DFS_csr() reaches
+inline bool parallel_mark_matches_dfs(CSRGraph* csr, int root, int numThreads) {
+    MarkBitmap* marks = createMarkBitmap(csr->numVertices);
+    MarkBitmap* parallel_marks = createMarkBitmap(csr->numVertices);
+    DFS_csr(csr, root, marks);
+    parallel_mark_csr(csr, &root, 1, numThreads, parallel_marks->words);
+    bool same = memcmp(marks->words, parallel_marks->words, marks->numWords * sizeof(uint64_t)) == 0;
+    freeMarkBitmap(marks);
+    freeMarkBitmap(parallel_marks);
+    return same;
+}
+
+// Define structure for a concurrent collector: a GC thread marks while a mutator thread edits
+// the graph. The mutator holds worldLock for each operation, so the GC takes it to stop the
+// mutator, and every adjacency list is read or written under its striped list lock
+typedef struct {
+    Graph* graph;
+    uint64_t* bits;
+    int numWords;
+    int* gray; // only touched by the GC thread
+    int grayTop;
+    int* satb; // vertices shaded by the mutator's barrier, drained by the GC thread
+    int satbTop;
+    std::mutex satbLock;
+    int* freeVertices; // swept vertices the mutator may allocate again
+    int numFree;
+    char* isFree;
+    std::mutex freeLock;
+    std::mutex worldLock;
+    std::mutex listLocks[LIST_LOCK_STRIPES];
+    std::atomic<bool> marking;
+    int yieldEvery; // scans between voluntary yields of the GC thread, 0 never yields
+    double maxRemarkUs;
+} ConcurrentCollector;
+
+inline std::mutex& list_lock(ConcurrentCollector* gc, int vertex) {
+    return gc->listLocks[vertex % LIST_LOCK_STRIPES];
+}
+
+// Function to shade a vertex for the GC thread; each vertex reaches the gray stack at most once
+inline void concurrent_shade(ConcurrentCollector* gc, int vertex) {
+    if (mark_bit_test_and_set(gc->bits, vertex))
+        gc->gray[gc->grayTop++] = vertex;
+}
+
+// Snapshot-at-the-beginning barrier: while marking, the target of a deleted edge is shaded,
+// so everything reachable when marking started is still marked
+inline void satb_barrier(ConcurrentCollector* gc, int dest) {
+    if (gc->marking.load(std::memory_order_acquire) && mark_bit_test_and_set(gc->bits, dest)) {
+        std::lock_guard<std::mutex> guard(gc->satbLock);
+        gc->satb[gc->satbTop++] = dest;
+    }
+}
+
+// Function to add the edge src -> dest from the mutator thread
+inline void concurrent_add_edge(ConcurrentCollector* gc, int src, int dest) {
+    std::lock_guard<std::mutex> guard(list_lock(gc, src));
+    addEdge(gc->graph, src, dest);
+}
+
+// Function to delete the first edge leaving src from the mutator thread, returns its target or -1
+inline int concurrent_remove_edge(ConcurrentCollector* gc, int src) {
+    std::lock_guard<std::mutex> guard(list_lock(gc, src));
+    Node* head = gc->graph->array[src];
+    if (head == NULL)
+        return -1;
+    int dest = head->data;
+    satb_barrier(gc, dest);
+    gc->graph->array[src] = head->next;
+    free(head);
+    return dest;
+}
+
+// Function to allocate a swept vertex from the mutator thread, -1 if none is free. Vertices
+// are born black so a sweep still in progress cannot take them back
+inline int concurrent_alloc_vertex(ConcurrentCollector* gc) {
+    std::lock_guard<std::mutex> guard(gc->freeLock);
+    if (gc->numFree == 0)
+        return -1;
+    int vertex = gc->freeVertices[--gc->numFree];
+    gc->isFree[vertex] = 0;
+    mark_bit_test_and_set(gc->bits, vertex);
+    return vertex;
+}
+
+// Function to follow the 'k'th edge of a vertex from the mutator thread, -1 if it has fewer
+inline int concurrent_follow(ConcurrentCollector* gc, int vertex, int k) {
+    std::lock_guard<std::mutex> guard(list_lock(gc, vertex));
+    Node* current = gc->graph->array[vertex];
+    while (current && k-- > 0)
+        current = current->next;
+    return current ? current->data : -1;
+}
+
+// Function to scan one gray vertex's adjacency list on the GC thread
+inline void concurrent_scan(ConcurrentCollector* gc, int vertex) {
+    std::lock_guard<std::mutex> guard(list_lock(gc, vertex));
+    for (Node* current = gc->graph->array[vertex]; current; current = current->next)
+        concurrent_shade(gc, current->data);
+}
+
+// Function to move the vertices shaded by the barrier onto the GC thread's gray stack
+inline void drain_satb(ConcurrentCollector* gc) {
+    std::lock_guard<std::mutex> guard(gc->satbLock);
+    while (gc->satbTop > 0)
+        gc->gray[gc->grayTop++] = gc->satb[--gc->satbTop];
+}
+
+// Function to run one collection on the GC thread: a short initial pause shades the root, the
+// bulk of marking runs concurrently with the mutator, and a final remark pause drains the
+// barrier's buffer before the unmarked lists are swept. 'reachable' receives the vertices
+// reachable at the end of the remark, and the function returns false if any of them is unmarked
+inline bool concurrent_collect(ConcurrentCollector* gc, int root, MarkBitmap* reachable) {
+    {
+        std::lock_guard<std::mutex> world(gc->worldLock);
+        memset(gc->bits, 0, gc->numWords * sizeof(uint64_t));
+        gc->grayTop = 0;
+        gc->satbTop = 0;
+        concurrent_shade(gc, root);
+        gc->marking.store(true, std::memory_order_release);
+    }
+    int scans = 0;
+    for (;;) {
+        while (gc->grayTop > 0) {
+            concurrent_scan(gc, gc->gray[--gc->grayTop]);
+            if (gc->yieldEvery > 0 && ++scans % gc->yieldEvery == 0)
+                std::this_thread::yield();
+        }
+        drain_satb(gc);
+        if (gc->grayTop == 0)
+            break;
+    }
+
+    bool safe = true;
+    {
+        std::lock_guard<std::mutex> world(gc->worldLock);
+        auto start = std::chrono::steady_clock::now();
+        drain_satb(gc);
+        while (gc->grayTop > 0)
+            concurrent_scan(gc, gc->gray[--gc->grayTop]);
+        gc->marking.store(false, std::memory_order_release);
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (us > gc->maxRemarkUs)
+            gc->maxRemarkUs = us;
+
+        // Check the mark against the graph as the stopped mutator sees it
+        clearMarkBitmap(reachable);
+        DFS_iterative(gc->graph, root, reachable);
+        for (int w = 0; w < reachable->numWords; w++) {
+            if (reachable->words[w] & ~gc->bits[w])
+                safe = false;
+        }
+    }
+
+    // Garbage is unreachable from the mutator, so the sweep needs no pause. A vertex already on
+    // the free list is unmarked too, and the mutator may allocate it at any time, so the mark is
+    // checked again under freeLock, which allocation holds while it blackens the vertex, and the
+    // list is dropped and the vertex freed under that same lock
+    for (int v = 0; v < gc->graph->numVertices; v++) {
+        if (__atomic_load_n(&gc->bits[v >> 6], __ATOMIC_RELAXED) & ((uint64_t)1 << (v & 63)))
+            continue;
+        Node* current;
+        {
+            std::lock_guard<std::mutex> freeGuard(gc->freeLock);
+            if (__atomic_load_n(&gc->bits[v >> 6], __ATOMIC_RELAXED) & ((uint64_t)1 << (v & 63)))
+                continue; // allocated since the check above
+            std::lock_guard<std::mutex> guard(list_lock(gc, v));
+            current = gc->graph->array[v];
+            gc->graph->array[v] = NULL;
+            if (!gc->isFree[v]) {
+                gc->isFree[v] = 1;
+                gc->freeVertices[gc->numFree++] = v;
+            }
+        }
+        while (current) {
+            Node* next = current->next;
+            free(current);
+            current = next;
+        }
+    }
+    return safe;
+}
+
+// Function to run 'numOps' random mutator operations (edge insertions, deletions and moves,
+// vertex allocation and reads, all on vertices reached from vertex 0) on one thread while, if
+// 'withGC' is set, a GC thread collects concurrently. 'interleave' makes both threads yield
+// after every operation or scan so races show up even on a single core. Returns false if a
+// collection ever left a live vertex unmarked or a vertex the mutator reaches was on the free
+// list; reports mutator throughput and the longest remark
+inline bool concurrent_mark_stress(int numVertices, int numOps, unsigned seed, bool withGC, bool interleave,
+                            double* opsPerSec, double* maxRemarkUs, int* collections) {
+    ConcurrentCollector* gc = new ConcurrentCollector;
+    gc->graph = createGraph(numVertices);
+    gc->numWords = (numVertices + 63) / 64;
+    gc->bits = (uint64_t*)calloc(gc->numWords, sizeof(uint64_t));
+    gc->gray = (int*)malloc(numVertices * sizeof(int));
+    gc->satb = (int*)malloc(numVertices * sizeof(int));
+    gc->freeVertices = (int*)malloc(numVertices * sizeof(int));
+    gc->isFree = (char*)calloc(numVertices, sizeof(char));
+    gc->grayTop = gc->satbTop = gc->numFree = 0;
+    gc->marking.store(false);
+    gc->yieldEvery = interleave ? 1 : 0;
+    gc->maxRemarkUs = 0.0;
+    srand(seed);
+    for (int e = 0; e < 2 * numVertices; e++)
+        addEdge(gc->graph, rand() % numVertices, rand() % numVertices);
+
+    std::atomic<bool> mutatorDone(false);
+    std::atomic<bool> safe(true);
+    int cycles = 0;
+    MarkBitmap* reachable = createMarkBitmap(numVertices);
+    std::thread collector([&]() {
+        while (withGC && !mutatorDone.load(std::memory_order_acquire)) {
+            if (!concurrent_collect(gc, 0, reachable))
+                safe.store(false);
+            cycles++;
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned state = seed;
+    for (int op = 0; op < numOps; op++) {
+        if (interleave)
+            std::this_thread::yield();
+        std::lock_guard<std::mutex> world(gc->worldLock);
+        // Walk a few random edges from the root to find vertices the mutator can reach
+        int held[2] = {0, 0};
+        for (int h = 0; h < 2; h++) {
+            int steps = rand_r(&state) % 8;
+            for (int s = 0; s < steps; s++) {
+                int next = concurrent_follow(gc, held[h], rand_r(&state) % 3);
+                if (next < 0)
+                    break;
+                held[h] = next;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> guard(gc->freeLock);
+            if (gc->isFree[held[0]] || gc->isFree[held[1]])
+                safe.store(false);
+        }
+        int kind = rand_r(&state) % 10;
+        if (kind < 4) {
+            concurrent_add_edge(gc, held[0], held[1]);
+        } else if (kind < 6) {
+            concurrent_remove_edge(gc, held[0]);
+        } else if (kind < 8) {
+            // Move an edge: its target is relinked under the other held vertex, then unlinked
+            int dest = concurrent_follow(gc, held[0], 0);
+            if (dest >= 0) {
+                concurrent_add_edge(gc, held[1], dest);
+                concurrent_remove_edge(gc, held[0]);
+            }
+        } else if (kind < 9) {
+            int vertex = concurrent_alloc_vertex(gc);
+            if (vertex >= 0)
+                concurrent_add_edge(gc, held[0], vertex);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    mutatorDone.store(true, std::memory_order_release);
+    collector.join();
+
+    *opsPerSec = seconds > 0 ? numOps / seconds : 0.0;
+    *maxRemarkUs = gc->maxRemarkUs;
+    *collections = cycles;
+
+    // At the end no reachable vertex may be free, and no vertex may be on the free list twice
+    clearMarkBitmap(reachable);
+    DFS_iterative(gc->graph, 0, reachable);
+    int numFlagged = 0;
+    for (int v = 0; v < numVertices; v++) {
+        if (gc->isFree[v] && is_marked(reachable, v))
+            safe.store(false);
+        numFlagged += gc->isFree[v];
+    }
+    if (numFlagged != gc->numFree)
+        safe.store(false);
+    freeMarkBitmap(reachable);
+    for (int v = 0; v < numVertices; v++) {
+        Node* current = gc->graph->array[v];
+        while (current) {
+            Node* next = current->next;
+            free(current);
+            current = next;
+        }
+    }
+    free(gc->graph->array);
+    free(gc->graph);
+    free(gc->bits);
+    free(gc->gray);
+    free(gc->satb);
+    free(gc->freeVertices);
+    free(gc->isFree);
+    delete gc;
+    return safe.load();
+}
+
+// Function to check that marking a generated graph from its root, sequentially and in parallel,
+// reaches exactly its live vertices
+inline bool generated_graph_marks_live(const GenSpec* spec) {
+    EdgeList* edges = generate_edges(spec);
+    CSRGraph* csr = createCSRGraph(edges->numVertices, edges->src, edges->dest, (int)edges->numEdges);
+    MarkBitmap* marks = createMarkBitmap(csr->numVertices);
+    DFS_csr(csr, 0, marks);
+    bool exact = true;
+    for (int v = 0; v < csr->numVertices; v++) {
+        if (is_marked(marks, v) != (v < edges->numLive))
+            exact = false;
+    }
+    // The parallel marker has to agree, with enough threads that they steal from each other
+    exact = exact && parallel_mark_matches_dfs(csr, 0, PARALLEL_CHECK_THREADS);
+    freeMarkBitmap(marks);
+    freeCSRGraph(csr);
+    free_edges(edges);
+    return exact;
+}
+
+} // namespace marknsweep
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef REFANS_H
+#define REFANS_H
+
+//typed objects with pointer maps, collected by reference counting from a set of roots or by
+//mark and sweep with a side bitmap. Declared in namespace refans for RefAns.cpp and GCBench.cpp
+#include<stdio.h>
+#include<stdbool.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<string.h>
+#include "GCReport.h"
+#define MARK_STACK_OBJECTS 1024
+
+namespace refans
+{
+
+//object header; the reference fields and the payload of the object follow it in memory
+typedef struct node
+{
+    int data;
+    int index;//position in array[], keys the node's bit in the mark bitmap
+    int referenceCount;//reference count method
+    unsigned short type;//index into type_table, gives the layout of the object
+    unsigned int size;//object size in bytes, header included
+}Node;
+
+//layout of one object type: its size and a pointer map with the byte offset of every reference field
+typedef struct
+{
+	const char *name;
+	unsigned int size;
+	int num_ptrs;
+	const unsigned int *ptr_offsets;
+}TypeInfo;
+
+//reference fields start at the first pointer-aligned offset after the header
+#define FIELDS_OFFSET ((sizeof(Node)+sizeof(Node*)-1)&~(sizeof(Node*)-1))
+#define FIELD(k) (FIELDS_OFFSET+(k)*sizeof(Node*))
+
+enum {TYPE_LEAF,TYPE_BOX,TYPE_PAIR,TYPE_TRIPLE};
+
+const unsigned int box_ptrs[]={FIELD(0)};
+const unsigned int pair_ptrs[]={FIELD(0),FIELD(1)};
+const unsigned int triple_ptrs[]={FIELD(0),FIELD(1),FIELD(2)};
+
+const TypeInfo type_table[]=
+{
+	{"leaf",FIELD(0)+16,0,NULL},//16 byte payload, no references
+	{"box",FIELD(1),1,box_ptrs},
+	{"pair",FIELD(2)+8,2,pair_ptrs},//two references and an 8 byte payload
+	{"triple",FIELD(3),3,triple_ptrs},
+};
+
+ 
+inline Node **array=NULL;
+inline int num_objects=0;//slots in array[], the demo uses 8
+inline uint64_t *marks=NULL;//side mark bitmap for mark and sweep, one bit per slot of array[]
+
+
+
+inline void init_objects(int n);
+inline void clear_marks();
+inline Node* new_object(int type,int data,int index);
+inline Node** field_slot(Node* n,int k);
+inline int num_fields(Node* n);
+inline void print_node(int i);
+inline void set_field(int so,int k,int dest);
+inline void edgeSet(int so,int dest1,int dest2,int dest3);
+inline void reference_counting(Node** roots,int num_roots);
+inline bool is_marked(Node* n);
+inline void set_mark(Node* n);
+inline void mark_method(Node* root);
+inline void sweep_method();
+inline void release_children(Node* n);
+
+
+//makes room for n objects, every slot empty and unmarked
+inline void init_objects(int n)
+{
+	int i;
+	if(array!=NULL)
+	{
+		for(i=0;i<num_objects;i++)
+		{
+			free(array[i]);
+		}
+	}
+	free(array);
+	free(marks);
+	num_objects=n;
+	array=(Node**)calloc(n,sizeof(Node*));
+	marks=(uint64_t*)calloc((n+63)/64,sizeof(uint64_t));
+}
+//clears every bit of the mark bitmap
+inline void clear_marks()
+{
+	memset(marks,0,((num_objects+63)/64)*sizeof(uint64_t));
+}
+//allocates an object of the given type with all reference fields set to NULL
+inline Node* new_object(int type,int data,int index)
+{
+	Node* n=(Node*)calloc(1,type_table[type].size);
+	n->data=data;
+	n->index=index;
+	n->referenceCount=0;
+	n->type=type;
+	n->size=type_table[type].size;
+	return n;
+}
+//address of the k-th reference field of an object, found through its type's pointer map
+inline Node** field_slot(Node* n,int k)
+{
+	return (Node**)((char*)n+type_table[n->type].ptr_offsets[k]);
+}
+//number of reference fields of an object
+inline int num_fields(Node* n)
+{
+	return type_table[n->type].num_ptrs;
+}
+//function to display reference count and freed size
+inline void print_node(int i)
+{
+	printf("value=%d\t reference_count=%d freed_size=%d\n",array[i]->data,array[i]->referenceCount,array[i]->size);
+}
+//stores a reference to array[dest] in the k-th reference field of array[so]
+inline void set_field(int so,int k,int dest)
+{
+	if(k>=num_fields(array[so]))
+	{
+		fprintf(stderr,"Error: %s object %d has no reference field %d\n",type_table[array[so]->type].name,array[so]->data,k);
+		exit(1);
+	}
+	*field_slot(array[so],k)=array[dest];
+	array[dest]->referenceCount+=1;
+}
+//set edges between nodes
+inline void edgeSet(int so,int dest1,int dest2,int dest3)
+{
+	if(dest1!=-1)
+	{
+		set_field(so,0,dest1);
+	}
+	if(dest2!=-1)
+	{
+		set_field(so,1,dest2);
+	}
+	if(dest3!=-1)
+	{
+		set_field(so,2,dest3);
+	}
+	
+}
+//drops the references a garbage object holds on its children
+inline void release_children(Node* n)
+{
+	int k;
+	for(k=0;k<num_fields(n);k++)
+	{
+		if(*field_slot(n,k)!=NULL)
+		{
+			(*field_slot(n,k))->referenceCount-=1;
+		}
+	}
+}
+// if node is not reachable from any root then all the linkages from that particular node are removed, i.e.; reference counting
+// of its children is decreased by 1 as the node is now garbage.
+// the live set is computed once per collection by marking from every root, so shared children are visited only once
+inline void reference_counting(Node** roots,int num_roots)
+{
+	int i;
+	clear_marks();
+	for(i=0;i<num_roots;i++)
+	{
+		mark_method(roots[i]);
+	}
+	sweep_method();
+}
+// reads the mark bit of a node
+inline bool is_marked(Node* n)
+{
+	return (marks[n->index>>6]>>(n->index&63))&1;
+}
+// sets the mark bit of a node
+inline void set_mark(Node* n)
+{
+	marks[n->index>>6]|=(uint64_t)1<<(n->index&63);
+}
+// reusable mark stack; on overflow the node stays marked and is rescanned later
+inline Node *mark_stack[MARK_STACK_OBJECTS];
+inline int mark_stack_top=0;
+inline bool mark_stack_overflowed=false;
+
+// marks a node and pushes it for scanning
+inline void mark_push(Node* n)
+{
+	set_mark(n);
+	if(mark_stack_top<MARK_STACK_OBJECTS)
+	{
+		mark_stack[mark_stack_top++]=n;
+	}
+	else
+	{
+		mark_stack_overflowed=true;
+	}
+}
+
+// pushes the unmarked children of a node, walking the pointer map of its type
+inline void mark_children(Node* n)
+{
+	const TypeInfo *t=&type_table[n->type];
+	int k;
+	for(k=0;k<t->num_ptrs;k++)
+	{
+		Node* child=*(Node**)((char*)n+t->ptr_offsets[k]);
+		if(child!=NULL&&!is_marked(child))
+		{
+			mark_push(child);
+		}
+	}
+}
+
+// mark method, iterative so that long chains cannot overflow the call stack
+inline void mark_method(Node* root)
+{
+	int i;
+	if(root==NULL||is_marked(root))
+	{
+		return;
+	}
+	mark_stack_top=0;
+	mark_stack_overflowed=false;
+	mark_push(root);
+	while(mark_stack_top>0||mark_stack_overflowed)
+	{
+		while(mark_stack_top>0)
+		{
+			mark_children(mark_stack[--mark_stack_top]);
+		}
+		if(mark_stack_overflowed)
+		{
+			//rescan every marked node for children that were never pushed
+			mark_stack_overflowed=false;
+			for(i=0;i<num_objects;i++)
+			{
+				if(array[i]!=NULL&&is_marked(array[i]))
+				{
+					mark_children(array[i]);
+				}
+			}
+		}
+	}
+}
+// frees the space if mark bit is false i.e. zero
+// unmarked nodes are found 64 at a time from the zero bits of the bitmap; a garbage node may point at
+// another garbage node, so every child reference is dropped in a first pass and nothing is freed until the second
+inline void sweep_method()
+{
+	int i,w,pass;
+	for(pass=0;pass<2;pass++)
+	{
+		for(w=0;w*64<num_objects;w++)
+		{
+			uint64_t unmarked=~marks[w];
+			if(num_objects-w*64<64)
+			{
+				unmarked&=((uint64_t)1<<(num_objects-w*64))-1;//only slots of array[] have bits
+			}
+			while(unmarked!=0)
+			{
+				i=w*64+__builtin_ctzll(unmarked);
+				unmarked&=unmarked-1;
+				if(array[i]==NULL)
+				{
+					continue;
+				}
+				if(pass==0)
+				{
+					release_children(array[i]);
+					continue;
+				}
+				if(gc_report_object("garbage",i,array[i]->size))
+				{
+					printf("Garbage:");
+					print_node(i);
+				}
+				free(array[i]);
+				array[i]=NULL;
+			}
+		}
+	}
+	clear_marks();//clear the bitmap for the next collection
+}
+
+}//namespace refans
+
+#endif
@@ -1,127 +1,46 @@
-#include <stdio.h>
-#include <stdlib.h>
-#define MAX_NODES 100
+#include "RefrenceCounting.h"
 
-// Structure to represent the heap
-typedef struct {
-    int adjacency_matrix[MAX_NODES][MAX_NODES];
-    int reference_counts[MAX_NODES];
-    int node_count;
-} Heap;
+using namespace refcount;
 
-// Define structure for a node in adjacency list
-typedef struct Node {
-    int data;
-    struct Node* next;
-} Node;
-
-// Define structure for adjacency list
-typedef struct {
-    Node** array;
-    int numVertices;
-} Graph;
-
-// Function to create a new node
-Node* createNode(int data) {
-    Node* newNode = (Node*)malloc(sizeof(Node));
-    newNode->data = data;
-    newNode->next = NULL;
-    return newNode;
-}
-
-// Function to create a graph with 'numVertices' vertices
-Graph* createGraph(int numVertices) {
-    Graph* graph = (Graph*)malloc(sizeof(Graph));
-    graph->numVertices = numVertices;
-    graph->array = (Node**)malloc(numVertices * sizeof(Node*));
-    for (int i = 0; i < numVertices; ++i)
-        graph->array[i] = NULL;
-    return graph;
-}
-
-// Function to add an edge to an undirected graph
-void addEdge(Graph* graph, int src, int dest) {
-    Node* newNode = createNode(dest);
-    newNode->next = graph->array[src];
-    graph->array[src] = newNode;
-}
-
-// Function to convert adjacency list to adjacency matrix
-void adjacency_list_to_matrix(Graph* graph, int adj_matrix[][MAX_NODES]) {
-    for (int i = 0; i < graph->numVertices; i++) {
-        Node* temp = graph->array[i];
-        while (temp) {
-            adj_matrix[i][temp->data] = 1;
-            temp = temp->next;
-        }
-    }
-    
-}
-
-// Function to print adjacency matrix
-void print_adjacency_matrix(int adj_matrix[][MAX_NODES], int n_nodes) {
+// Function to print adjacency matrix, expanding one row at a time from the adjacency list
+void print_adjacency_matrix(Graph* graph, int n_nodes) {
+    if (!gc_report_verbose())
+        return;
     printf("Adjacency Matrix:\n");
+    int* row = (int*)malloc((n_nodes > 0 ? n_nodes : 1) * sizeof(int));
     for (int i = 0; i < n_nodes; i++) {
     		if(i!=0 && i!=4 && i!=6){
+        memset(row, 0, n_nodes * sizeof(int));
+        for (Node* temp = graph->array[i]; temp; temp = temp->next)
+            row[temp->data] = 1;
         for (int j = 0; j < n_nodes; j++) {
         		if(j!=0 && j!=4 && j!=6){
-            printf("%d ", adj_matrix[i][j]);
+            printf("%d ", row[j]);
         }}
 		 printf("\n");}
     }
-}
-
-// Function to initialize the heap
-void initialize_heap(Heap *heap, int adjacency_matrix[MAX_NODES][MAX_NODES], int node_count) {
-    int i, j;
-    heap->node_count = node_count;
-    for (i = 0; i < node_count; i++) {
-        for (j = 0; j < node_count; j++) {
-            heap->adjacency_matrix[i][j] = adjacency_matrix[i][j];
-        }
-        heap->reference_counts[i] = 0;
-    }
-}
-
-// Function to increment reference count for a node
-void increment_reference_count(Heap *heap, int node) {
-    heap->reference_counts[node]++;
-}
-
-// Function to decrement reference count for a node
-void decrement_reference_count(Heap *heap, int node) {
-    heap->reference_counts[node]--;
-}
-
-// Function to mark references in the heap
-void mark_references(Heap *heap) {
-    int i, j;
-    for (i = 0; i < heap->node_count; i++) {
-        for (j = 0; j < heap->node_count; j++) {
-            if (heap->adjacency_matrix[i][j] == 1) {
-                increment_reference_count(heap, j);
-            }
-        }
-    }
-	heap->reference_counts[1]++;//due to root_2
-	heap->reference_counts[5]++;//due to root_1
+    free(row);
 }
 
 // Function to find garbage nodes
 void find_garbage_nodes(Heap *heap) {
     int i;
-    printf("Garbage nodes:\n");
+    if (gc_report_verbose())
+        printf("Garbage nodes:\n");
     int sum=0;
     for (i = 0; i < heap->node_count; i++) {
         if ((heap->reference_counts[i] == 0) && (i!=4 && i!=0 && i!=6)) {
         	sum=sum+ sizeof(i)+sizeof(Node);
-            printf("node value=%d , memory freed=%d\n", i, sizeof(i)+sizeof(Node));
+            if (gc_report_object("garbage", i, sizeof(i) + sizeof(Node)))
+                printf("node value=%d , memory freed=%d\n", i, sizeof(i)+sizeof(Node));
         }
     }
      printf("total memory freed=%d\n", sum);
 }
 
 void printAdj_list(Graph* graph){
+	if(!gc_report_verbose())
+		return;
 	int num=graph->numVertices;
 	for(int i=0;i<num;i++){
 		if(i!=0 && i!=4 && i!=6){
@@ -136,8 +55,8 @@ void printAdj_list(Graph* graph){
 	}
 }
 
-
 int main() {
+    gc_report_from_env();
     int numVertices = 11;
     Graph* graph = createGraph(numVertices);
 	printf("REFERENCE COUNTING\n");
@@ -153,23 +72,88 @@ int main() {
     printf("the required adjacent list is :\n");
 	printAdj_list(graph);
 
-    // Initialize adjacency matrix with all zeros
-    int adj_matrix[MAX_NODES][MAX_NODES] = {0};
-
-    // Convert adjacency list to adjacency matrix
-    adjacency_list_to_matrix(graph, adj_matrix);
 
 	printf("the required adjacent matrix is :\n");
     // Print adjacency matrix
-    print_adjacency_matrix(adj_matrix, numVertices);
+    print_adjacency_matrix(graph, numVertices);
     
     Heap heap;
-    initialize_heap(&heap, adj_matrix, numVertices);
+    initialize_heap(&heap, graph);
     mark_references(&heap);
     printf("refrence counting done successfully:\n");
     printf("freeing the node with zero reference count and displaying along with the memory freed:\n");
     find_garbage_nodes(&heap);
 
+    printf("reference counting on the CSR form of the graph:\n");
+    CSRGraph* csr = graph_to_csr(graph);
+    mark_references_csr(&heap, csr);
+    find_garbage_nodes(&heap);
+    freeCSRGraph(csr);
+
+    printf("incremental reference counting with root_1 -> 5 and root_2 -> 1:\n");
+    Heap live_heap;
+    initialize_heap(&live_heap, createGraph(numVertices));
+    set_root(&live_heap, 5);
+    set_root(&live_heap, 1);
+    add_ref(&live_heap, 1, 9);
+    add_ref(&live_heap, 1, 2);
+    add_ref(&live_heap, 1, 10);
+    add_ref(&live_heap, 3, 8);
+    add_ref(&live_heap, 3, 10);
+    add_ref(&live_heap, 5, 1);
+    add_ref(&live_heap, 7, 1);
+    add_ref(&live_heap, 7, 8);
+    add_ref(&live_heap, 8, 9);
+    printf("dropping root_1:\n");
+    clear_root(&live_heap, 5);
+    printf("dropping root_2:\n");
+    clear_root(&live_heap, 1);
+    printf("dropping the reference 7 -> 1:\n");
+    drop_ref(&live_heap, 7, 1);
+
+    printf("cycle collection: a ring 1 -> 2 -> 3 -> 1 and a figure-eight 4 <-> 5 <-> 6 rooted at 1 and 5:\n");
+    Heap cyclic_heap;
+    initialize_heap(&cyclic_heap, createGraph(7));
+    set_root(&cyclic_heap, 1);
+    set_root(&cyclic_heap, 5);
+    add_ref(&cyclic_heap, 1, 2);
+    add_ref(&cyclic_heap, 2, 3);
+    add_ref(&cyclic_heap, 3, 1);
+    add_ref(&cyclic_heap, 4, 5);
+    add_ref(&cyclic_heap, 5, 4);
+    add_ref(&cyclic_heap, 5, 6);
+    add_ref(&cyclic_heap, 6, 5);
+    clear_root(&cyclic_heap, 1);
+    clear_root(&cyclic_heap, 5);
+    printf("collecting cycles:\n");
+    printf("cyclic nodes freed=%d\n", collect_cycles(&cyclic_heap));
+
+    printf("cycle collection in deferred mode, a ring 1 <-> 2 that root 1 still holds:\n");
+    Heap rooted_heap;
+    initialize_heap(&rooted_heap, createGraph(3));
+    set_deferred_mode(&rooted_heap, 1);
+    set_root(&rooted_heap, 1);
+    add_ref(&rooted_heap, 1, 2);
+    add_ref(&rooted_heap, 2, 1);
+    add_ref(&rooted_heap, 0, 2);
+    drop_ref(&rooted_heap, 0, 2); // leaves 2 buffered as a candidate cycle root
+    printf("cyclic nodes freed=%d\n", collect_cycles(&rooted_heap));
+
+    printf("cycle collection on a ring of 100 rings of 100 nodes:\n");
+    printf("every node freed once unrooted: %s\n", ring_of_rings_collected(100, 100, 0) ? "yes" : "no");
+    printf("rooted ring of rings survives intact: %s\n", ring_of_rings_collected(100, 100, 1) ? "yes" : "no");
+
+    printf("deferred reference counting on a synthetic mutator trace:\n");
+    Heap counted_heap, deferred_heap;
+    initialize_heap(&counted_heap, createGraph(64));
+    initialize_heap(&deferred_heap, createGraph(64));
+    set_deferred_mode(&deferred_heap, 1);
+    run_synthetic_trace(&counted_heap, 64, 10000, 1);
+    run_synthetic_trace(&deferred_heap, 64, 10000, 1);
+    printf("immediate: count updates=%ld\n", counted_heap.count_updates);
+    printf("deferred: count updates=%ld, root updates not counted=%ld (%.1f%% saved)\n",
+           deferred_heap.count_updates, deferred_heap.skipped_updates,
+           100.0 * (counted_heap.count_updates - deferred_heap.count_updates) / counted_heap.count_updates);
+
     return 0;
 }
-
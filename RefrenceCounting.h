@@ -0,0 +1,128 @@
+#ifndef REFRENCECOUNTING_H
+#define REFRENCECOUNTING_H
+
+// Reference counting over malloc()ed adjacency-list graphs, using the trial-deletion cycle
+// collection and the deferred zero count table mode of GCCore.h. Declared in namespace refcount
+// for RefrenceCounting.cpp and GCBench.cpp
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GCReport.h"
+#include "GCCore.h"
+
+namespace refcount {
+
+using namespace gccore;
+
+// Function to create a new node
+inline Node* createNode(int data) {
+    Node* newNode = (Node*)malloc(sizeof(Node));
+    newNode->data = data;
+    newNode->next = NULL;
+    return newNode;
+}
+
+// Function to create a graph with 'numVertices' vertices
+inline Graph* createGraph(int numVertices) {
+    Graph* graph = (Graph*)malloc(sizeof(Graph));
+    graph->numVertices = numVertices;
+    graph->array = (Node**)malloc(numVertices * sizeof(Node*));
+    for (int i = 0; i < numVertices; ++i)
+        graph->array[i] = NULL;
+    return graph;
+}
+
+// Function to add an edge to an undirected graph
+inline void addEdge(Graph* graph, int src, int dest) {
+    Node* newNode = createNode(dest);
+    newNode->next = graph->array[src];
+    graph->array[src] = newNode;
+}
+
+// Function to replay a synthetic mutator trace on a live chain of 'n' nodes hanging off root 0:
+// most operations push and pop root slots, the rest add and drop extra heap references
+inline void run_synthetic_trace(Heap *heap, int n, int ops, unsigned seed) {
+    int i;
+    srand(seed);
+    set_root(heap, 0);
+    for (i = 0; i + 1 < n; i++)
+        add_ref(heap, i, i + 1);
+    for (i = 0; i < ops; i++) {
+        int a = 1 + rand() % (n - 1), b = 1 + rand() % (n - 1), op = rand() % 10;
+        if (op < 4)
+            set_root(heap, a);
+        else if (op < 8)
+            clear_root(heap, a);
+        else if (op == 8)
+            add_ref(heap, a, b);
+        else if (heap->graph->array[a] && heap->graph->array[a]->data != a + 1)
+            drop_ref(heap, a, heap->graph->array[a]->data); // never the chain edge, which is added first
+        if (heap->deferred && i % 256 == 255)
+            reconcile_zct(heap);
+    }
+}
+
+// Function to check trial deletion on one large strongly connected component: 'rings' rings of
+// 'ring_size' nodes, the first node of each ring also pointing at the next ring. With 'rooted' a
+// root keeps node 0, and the whole component must survive with its counts intact; without it
+// every node must be freed
+inline bool ring_of_rings_collected(int rings, int ring_size, int rooted) {
+    int n = rings * ring_size, mode = gc_report.mode, freed, r, i, v;
+    bool ok = true;
+    Heap heap;
+    initialize_heap(&heap, createGraph(n + 1)); // vertex n holds a short-lived outside reference
+    set_root(&heap, 0);
+    for (r = 0; r < rings; r++) {
+        for (i = 0; i < ring_size; i++)
+            add_ref(&heap, r * ring_size + i, r * ring_size + (i + 1) % ring_size);
+        add_ref(&heap, r * ring_size, (r + 1) % rings * ring_size);
+    }
+    int* expected = (int*)malloc(n * sizeof(int));
+    memcpy(expected, heap.reference_counts, n * sizeof(int));
+    add_ref(&heap, n, n / 2);
+    drop_ref(&heap, n, n / 2); // leaves n/2 buffered as a candidate cycle root
+    if (!rooted)
+        clear_root(&heap, 0);
+    gc_report.mode = GC_REPORT_SUMMARY; // one line per freed node would swamp the demo
+    freed = collect_cycles(&heap);
+    gc_report.mode = mode;
+    if (freed != (rooted ? 0 : n))
+        ok = false;
+    for (v = 0; v < n; v++) {
+        if (rooted ? heap.freed[v] || heap.reference_counts[v] != expected[v]
+                   : !heap.freed[v] || heap.graph->array[v] != NULL)
+            ok = false;
+    }
+    free(expected);
+    free_heap(&heap);
+    return ok;
+}
+
+// Function to mark references in the heap
+inline void mark_references(Heap *heap) {
+    int i;
+    for (i = 0; i < heap->node_count; i++) {
+        for (Node* temp = heap->graph->array[i]; temp; temp = temp->next) {
+            increment_reference_count(heap, temp->data);
+        }
+    }
+	heap->reference_counts[1]++;//due to root_2
+	heap->reference_counts[5]++;//due to root_1
+}
+
+// Function to count references straight from the CSR target array, one pass over the edges
+inline void mark_references_csr(Heap *heap, CSRGraph* csr) {
+    heap->node_count = csr->numVertices;
+    heap->reference_counts = (int*)realloc(heap->reference_counts, csr->numVertices * sizeof(int));
+    for (int i = 0; i < csr->numVertices; i++)
+        heap->reference_counts[i] = 0;
+    for (int e = 0; e < csr->numEdges; e++) {
+        increment_reference_count(heap, csr->targets[e]);
+    }
+	heap->reference_counts[1]++;//due to root_2
+	heap->reference_counts[5]++;//due to root_1
+}
+
+} // namespace refcount
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Binary heap traces: a fixed header followed by fixed-size events, so a trace can be
+// memory-mapped and replayed as a flat array without parsing
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define TRACE_MAGIC 0x52544347u // "GCTR"
+#define TRACE_VERSION 1
+#define TRACE_NULL 0xFFFFFFFFu // target of a store that clears a field
+#define TRACE_MAX_SLOTS 4 // pointer fields per object a store may name
+
+// Events recorded in a trace
+enum {
+    TRACE_ALLOC, // obj = new object id, arg = size in bytes; an id may be reused once it is freed
+    TRACE_FREE, // obj = object explicitly freed by the program; collecting replays take it as a hint
+    TRACE_STORE, // field 'slot' of obj now points at arg, or at nothing if arg is TRACE_NULL
+    TRACE_ROOT_ADD, // obj becomes a root
+    TRACE_ROOT_REMOVE // obj stops being a root
+};
+
+// Structure to represent the trace header
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_objects; // object ids are 0 .. num_objects - 1
+    uint32_t reserved;
+    uint64_t num_events;
+} TraceHeader;
+
+// Structure to represent one event, 12 bytes on disk
+typedef struct {
+    uint8_t op;
+    uint8_t slot;
+    uint16_t reserved;
+    uint32_t obj;
+    uint32_t arg;
+} TraceEvent;
+
+// Structure to represent a trace being written
+typedef struct {
+    FILE* file;
+    TraceHeader header;
+} TraceWriter;
+
+// Structure to represent a memory-mapped trace
+typedef struct {
+    void* base;
+    size_t length;
+    const TraceHeader* header;
+    const TraceEvent* events;
+} TraceMap;
+
+// Function to start writing a trace over 'num_objects' object ids, NULL on failure
+inline TraceWriter* trace_open_writer(const char* path, uint32_t num_objects) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return NULL;
+    TraceWriter* writer = (TraceWriter*)malloc(sizeof(TraceWriter));
+    writer->file = file;
+    writer->header.magic = TRACE_MAGIC;
+    writer->header.version = TRACE_VERSION;
+    writer->header.num_objects = num_objects;
+    writer->header.reserved = 0;
+    writer->header.num_events = 0;
+    fwrite(&writer->header, sizeof(TraceHeader), 1, file);
+    return writer;
+}
+
+// Function to append one event to a trace
+inline void trace_write(TraceWriter* writer, uint8_t op, uint32_t obj, uint32_t arg, uint8_t slot) {
+    TraceEvent event = {op, slot, 0, obj, arg};
+    fwrite(&event, sizeof(TraceEvent), 1, writer->file);
+    writer->header.num_events++;
+}
+
+// Function to finish a trace, filling in the event count; returns 0 on success
+inline int trace_close_writer(TraceWriter* writer) {
+    int failed = fseek(writer->file, 0, SEEK_SET) != 0 ||
+                 fwrite(&writer->header, sizeof(TraceHeader), 1, writer->file) != 1;
+    failed |= fclose(writer->file) != 0;
+    free(writer);
+    return failed ? -1 : 0;
+}
+
+// Function to find the byte offset of event 'e' in the trace file, for error messages
+inline unsigned long long trace_event_offset(uint64_t e) {
+    return (unsigned long long)(sizeof(TraceHeader) + e * sizeof(TraceEvent));
+}
+
+// Function to check that event 'e' names a known op and only object ids and slots the header
+// allows; prints what is wrong with it and returns -1 if it does not
+inline int trace_check_event(const TraceHeader* header, const TraceEvent* ev, uint64_t e) {
+    const char* problem = NULL;
+    if (ev->op > TRACE_ROOT_REMOVE)
+        problem = "unknown op";
+    else if (ev->obj >= header->num_objects)
+        problem = "object id out of range";
+    else if (ev->op == TRACE_STORE && ev->slot >= TRACE_MAX_SLOTS)
+        problem = "slot out of range";
+    else if (ev->op == TRACE_STORE && ev->arg != TRACE_NULL && ev->arg >= header->num_objects)
+        problem = "store target out of range";
+    if (problem == NULL)
+        return 0;
+    fprintf(stderr, "Error: Trace event %llu at offset %llu: %s (op %u, slot %u, obj %u, arg %u)\n",
+            (unsigned long long)e, trace_event_offset(e), problem, ev->op, ev->slot, ev->obj, ev->arg);
+    return -1;
+}
+
+// Function to map a trace read-only; returns 0 on success, -1 if it is missing or its header is
+// malformed. Events are not checked here: a replay passes each one to trace_check_event() as it
+// reads it, so the check is timed with the replay and the trace is only read once
+inline int trace_map(const char* path, TraceMap* map) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+        close(fd);
+        return -1;
+    }
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+    map->base = base;
+    map->length = st.st_size;
+    map->header = (const TraceHeader*)base;
+    map->events = (const TraceEvent*)(map->header + 1);
+    if (map->header->magic != TRACE_MAGIC || map->header->version != TRACE_VERSION ||
+        map->header->num_events > (map->length - sizeof(TraceHeader)) / sizeof(TraceEvent)) {
+        munmap(base, map->length);
+        return -1;
+    }
+    // Replay reads the events front to back
+    madvise(base, map->length, MADV_SEQUENTIAL);
+    return 0;
+}
+
+// Function to unmap a trace
+inline void trace_unmap(TraceMap* map) {
+    munmap(map->base, map->length);
+}
+
+// Function to write a small trace whose program frees objects and allocates their ids again: an
+// unreferenced object, one dropped from a root's field and a garbage cycle are each freed and
+// reallocated, and the reallocated cycle object stores into a slot it used before it was freed.
+// Objects 0, 1, 3 and 4 are live at the end, TRACE_REUSE_LIVE of them. Returns 0 on success
+#define TRACE_REUSE_LIVE 4
+inline int trace_write_id_reuse(const char* path) {
+    TraceWriter* writer = trace_open_writer(path, 5);
+    if (writer == NULL)
+        return -1;
+    trace_write(writer, TRACE_ALLOC, 0, 32, 0);
+    trace_write(writer, TRACE_ROOT_ADD, 0, 0, 0);
+    trace_write(writer, TRACE_ALLOC, 1, 32, 0);
+    trace_write(writer, TRACE_STORE, 0, 1, 0);
+    // Never referenced
+    trace_write(writer, TRACE_ALLOC, 2, 32, 0);
+    trace_write(writer, TRACE_FREE, 2, 0, 0);
+    trace_write(writer, TRACE_ALLOC, 2, 64, 0);
+    trace_write(writer, TRACE_FREE, 2, 0, 0);
+    // Dropped from the root's field, then stored into another one
+    trace_write(writer, TRACE_STORE, 0, TRACE_NULL, 0);
+    trace_write(writer, TRACE_FREE, 1, 0, 0);
+    trace_write(writer, TRACE_ALLOC, 1, 32, 0);
+    trace_write(writer, TRACE_STORE, 0, 1, 1);
+    // A cycle 3 <-> 4 hanging off the root until its field is cleared
+    trace_write(writer, TRACE_ALLOC, 3, 32, 0);
+    trace_write(writer, TRACE_ALLOC, 4, 32, 0);
+    trace_write(writer, TRACE_STORE, 3, 4, 0);
+    trace_write(writer, TRACE_STORE, 4, 3, 0);
+    trace_write(writer, TRACE_STORE, 0, 3, 2);
+    trace_write(writer, TRACE_STORE, 0, TRACE_NULL, 2);
+    trace_write(writer, TRACE_FREE, 3, 0, 0);
+    trace_write(writer, TRACE_FREE, 4, 0, 0);
+    // The new 3 must start with empty fields: clearing slot 0 must not drop its slot 1 reference to 4
+    trace_write(writer, TRACE_ALLOC, 3, 32, 0);
+    trace_write(writer, TRACE_STORE, 1, 3, 0);
+    trace_write(writer, TRACE_ALLOC, 4, 32, 0);
+    trace_write(writer, TRACE_STORE, 3, 4, 1);
+    trace_write(writer, TRACE_STORE, 3, TRACE_NULL, 0);
+    return trace_close_writer(writer);
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef TRY1_H
+#define TRY1_H
+
+// Graphs allocated in the block heap of GCCore.h and collected by its reference counting, plus
+// the replay of recorded traces. Declared in namespace blockrc for try1.cpp and GCBench.cpp
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "Trace.h"
+#include "GCStats.h"
+#include "GCReport.h"
+#include "GCCore.h"
+#define REPLAY_GC_BYTES (8 << 20) // allocation between collections while replaying a trace
+
+namespace blockrc {
+
+using namespace gccore;
+
+// Function to create a new node
+inline Node* createNode(int data) {
+   // Node* newNode = (Node*)malloc(sizeof(Node));
+    Node* newNode =(Node *)alloc(sizeof(Node));
+    if (newNode == NULL) {
+        fprintf(stderr, "Error: Heap exhausted\n");
+        exit(1);
+    }
+    newNode->data = data;
+    newNode->next = NULL;
+    return newNode;
+}
+
+// Function to create a graph with 'numVertices' vertices
+inline Graph* createGraph(int numVertices) {
+    Graph* graph = (Graph*)alloc(sizeof(Graph));
+    graph->numVertices = numVertices;
+    graph->array = (Node**)malloc(numVertices * sizeof(Node*));
+    for (int i = 0; i < numVertices; ++i)
+        graph->array[i] = NULL;
+    return graph;
+}
+
+// Function to add an edge to an undirected graph
+inline void addEdge(Graph* graph, int src, int dest) {
+    Node* newNode = createNode(dest);
+    newNode->next = graph->array[src];
+    graph->array[src] = newNode;
+}
+
+// Function to mark references in the heap
+inline void mark_references(Heap *heap) {
+    int i;
+    for (i = 0; i < heap->node_count; i++) {
+        for (Node* temp = heap->graph->array[i]; temp; temp = temp->next) {
+            increment_reference_count(heap, temp->data);
+        }
+    }
+	heap->reference_counts[1]++;//due to root_2
+	heap->reference_counts[5]++;//due to root_1
+}
+
+// Function to free and merge nodes in the graph based on their reference counts
+inline void free_and_merge_nodes(Graph* graph, Heap *heap) {
+    // Collect the garbage first so the heap is coalesced once for the whole batch
+    int count = 0, capacity = 16;
+    void **garbage = (void **)malloc(capacity * sizeof(void *));
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (heap->reference_counts[i] == 0) {
+            Node* current = graph->array[i];
+            while (current) {
+                if (count == capacity) {
+                    capacity *= 2;
+                    garbage = (void **)realloc(garbage, capacity * sizeof(void *));
+                }
+                garbage[count++] = (void *)current;
+                if (!quiet && gc_report_object("freed", current->data, sizeof(Node)))
+                    printf("Node %d freed.\n", current->data);
+                current = current->next;
+            }
+            graph->array[i] = NULL;
+        }
+    }
+    free_mem_many(garbage, count);
+    free(garbage);
+    printf("Freeing and merging nodes completed successfully!\n");
+}
+
+
+// Structure to represent the outcome of replaying a trace
+typedef struct {
+    double seconds;
+    int collections;
+    size_t mapped; // bytes of heap mapped at the end
+    long count_updates; // reference count writes, zero in "alloc" mode
+    long skipped_updates; // root updates left uncounted in "deferred" mode
+    long live_objects; // objects still allocated at the end
+} ReplayResult;
+
+// Function to take an explicit free from a counting replay as a hint: an object no reference or
+// root keeps alive is freed at once, one still referenced may be held by a garbage cycle and is
+// left to the next cycle collection
+inline void replay_free_hint(Heap *heap, int obj) {
+    if (heap->freed[obj] || heap->payload[obj] == NULL)
+        return;
+    if (heap->reference_counts[obj] == 0 && !heap->is_root[obj])
+        release_object(heap, obj);
+    else if (heap->reference_counts[obj] > 0)
+        possible_root(heap, obj);
+}
+
+// Function to replay a mapped heap trace on a heap set up with init_heap(). "alloc" mode forwards
+// allocations and explicit frees to alloc()/free_mem(); "rc" mode lets reference counting reclaim
+// objects, taking explicit frees as hints, with a cycle collection after every REPLAY_GC_BYTES of
+// allocation and before an id still live is allocated again; "deferred" mode does the same with
+// root references left uncounted, reconciled at each collection. Every event is checked as it is
+// read. The objects left are freed before returning, and the allocation policy is restored.
+// Returns 0 on success
+inline int replay_events(const TraceMap* trace, const char* mode, ReplayResult* result) {
+    int deferred = strcmp(mode, "deferred") == 0;
+    int counting = deferred || strcmp(mode, "rc") == 0;
+    if (!counting && strcmp(mode, "alloc") != 0) {
+        fprintf(stderr, "Error: Unknown replay mode %s\n", mode);
+        return 1;
+    }
+    // Size classes keep allocation O(1) however many objects the trace keeps live
+    int was_mode = alloc_mode;
+    set_alloc_mode(ALLOC_SEGREGATED);
+    int was_quiet = quiet;
+    quiet = 1;
+    int n = (int)trace->header->num_objects;
+    void** payload = (void**)calloc(n, sizeof(void*));
+    uint32_t* fields = (uint32_t*)malloc((size_t)n * TRACE_MAX_SLOTS * sizeof(uint32_t));
+    memset(fields, 0xFF, (size_t)n * TRACE_MAX_SLOTS * sizeof(uint32_t));
+    Heap heap;
+    initialize_heap(&heap, createGraph(n), true);
+    if (counting) {
+        heap.payload = payload;
+        heap.fields = fields;
+    }
+    if (deferred)
+        set_deferred_mode(&heap, 1);
+    size_t since_collection = 0;
+    int collections = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t num_events = trace->header->num_events;
+    int status = 0;
+    for (uint64_t e = 0; e < num_events && status == 0; e++) {
+        const TraceEvent* ev = &trace->events[e];
+        if (trace_check_event(trace->header, ev, e) != 0) {
+            status = 1;
+            break;
+        }
+        switch (ev->op) {
+        case TRACE_ALLOC:
+            if (counting && payload[ev->obj]) {
+                // Let the collector decide whether the program's free of this id was right
+                collect_cycles(&heap);
+                collections++;
+            }
+            if (payload[ev->obj]) {
+                fprintf(stderr, "Error: Trace event %llu at offset %llu allocates object %u, which is still live\n",
+                        (unsigned long long)e, trace_event_offset(e), ev->obj);
+                status = 1;
+                break;
+            }
+            payload[ev->obj] = alloc(ev->arg);
+            // The id may have been used before, start it as a new object
+            heap.reference_counts[ev->obj] = 0;
+            heap.freed[ev->obj] = 0;
+            heap.color[ev->obj] = COLOR_BLACK;
+            memset(&fields[(size_t)ev->obj * TRACE_MAX_SLOTS], 0xFF, TRACE_MAX_SLOTS * sizeof(uint32_t));
+            since_collection += ev->arg;
+            if (counting && since_collection > REPLAY_GC_BYTES) {
+                collect_cycles(&heap);
+                since_collection = 0;
+                collections++;
+            }
+            break;
+        case TRACE_FREE:
+            if (counting) {
+                replay_free_hint(&heap, ev->obj);
+            } else {
+                free_mem(payload[ev->obj]);
+                payload[ev->obj] = NULL;
+            }
+            break;
+        case TRACE_STORE: {
+            if (!counting)
+                break;
+            uint32_t* field = &fields[(size_t)ev->obj * TRACE_MAX_SLOTS + ev->slot];
+            uint32_t old = *field;
+            *field = ev->arg;
+            // Count the new reference before dropping the old one, storing the same target twice must not free it
+            if (ev->arg != TRACE_NULL)
+                add_ref(&heap, ev->obj, ev->arg);
+            if (old != TRACE_NULL)
+                drop_ref(&heap, ev->obj, old);
+            break;
+        }
+        case TRACE_ROOT_ADD:
+            if (counting)
+                set_root(&heap, ev->obj);
+            break;
+        case TRACE_ROOT_REMOVE:
+            if (counting)
+                clear_root(&heap, ev->obj);
+            break;
+        }
+    }
+    if (status == 0 && counting) {
+        collect_cycles(&heap);
+        collections++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (status == 0) {
+        result->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        result->collections = collections;
+        result->mapped = 0;
+        for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next)
+            result->mapped += chunk->size;
+        result->count_updates = heap.count_updates;
+        result->skipped_updates = heap.skipped_updates;
+        result->live_objects = 0;
+        for (int i = 0; i < n; i++)
+            result->live_objects += payload[i] != NULL;
+    }
+    for (int i = 0; i < n; i++)
+        free_mem(payload[i]);
+    free_heap(&heap);
+    free(payload);
+    free(fields);
+    set_alloc_mode(was_mode);
+    quiet = was_quiet;
+    return status;
+}
+
+// Function to replay the heap trace at 'path' in one of replay_events()'s modes and print a
+// summary. Returns 0 on success
+inline int replay_trace(const char* path, const char* mode) {
+    TraceMap trace;
+    if (trace_map(path, &trace) != 0) {
+        fprintf(stderr, "Error: Unable to read trace %s\n", path);
+        return 1;
+    }
+    init_heap();
+    ReplayResult result;
+    int status = replay_events(&trace, mode, &result);
+    uint64_t num_events = trace.header->num_events;
+    trace_unmap(&trace);
+    if (status != 0)
+        return status;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("Replayed %llu events in %.3f s (%.1f M events/sec)\n", (unsigned long long)num_events,
+           result.seconds, result.seconds > 0 ? num_events / result.seconds / 1e6 : 0.0);
+    printf("Heap mapped = %zu bytes, peak RSS = %ld KB, cycle collections = %d\n", result.mapped,
+           usage.ru_maxrss, result.collections);
+    if (strcmp(mode, "alloc") != 0)
+        printf("Count updates = %ld, root updates not counted = %ld\n", result.count_updates,
+               result.skipped_updates);
+    return 0;
+}
+
+// Function to check that a trace freeing objects and allocating their ids again replays in every
+// mode, leaving the objects its program keeps
+inline bool replay_reuses_ids() {
+    const char* modes[] = {"alloc", "rc", "deferred"};
+    char path[] = "/tmp/try1-trace-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+    close(fd);
+    TraceMap trace;
+    bool mapped = trace_write_id_reuse(path) == 0 && trace_map(path, &trace) == 0;
+    bool ok = mapped;
+    unlink(path);
+    for (int m = 0; ok && m < 3; m++) {
+        ReplayResult result;
+        ok = replay_events(&trace, modes[m], &result) == 0 && result.live_objects == TRACE_REUSE_LIVE;
+    }
+    if (mapped)
+        trace_unmap(&trace);
+    return ok;
+}
+
+} // namespace blockrc
+
+#endif
@@ -0,0 +1,998 @@
+#ifndef TRY2_H
+#define TRY2_H
+
+// Chunked block heap with mark-and-sweep, lazy sweeping, mark-compact, a semispace copying
+// collector and a generational nursery over graphs allocated in it. The heap and the marker come
+// from GCCore.h. Declared in namespace blockms for try2.cpp and GCBench.cpp
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include "Trace.h"
+#include "GCStats.h"
+#include "GCReport.h"
+#include "GCCore.h"
+#define REPLAY_GC_BYTES (8 << 20) // allocation between collections while replaying a trace
+#ifndef SEMISPACE_SIZE
+#define SEMISPACE_SIZE (1 << 20) // bytes in each half of the copying heap, may be raised at compile time
+#endif
+#define NURSERY_SIZE (1 << 18) // bytes of young nodes allocated between minor collections
+#define LAZY_SWEEP_PAGES 4 // pages of garbage reclaimed by each lazy sweep step
+#define PAUSE_BUCKETS 20 // bucket b counts pauses shorter than 2^b microseconds
+
+namespace blockms {
+
+using namespace gccore;
+
+// Allocation policies added to the block heap's: ALLOC_SEMISPACE and ALLOC_GENERATIONAL bump
+// allocate graph nodes in the copying heap or the nursery, the graph header and vertex array still
+// come from the block heap
+enum { ALLOC_SEMISPACE = ALLOC_SEGREGATED + 1, ALLOC_GENERATIONAL };
+
+// Header in front of every object in the copying heap
+typedef struct SpaceObject {
+    size_t size;
+    void *forward; // to-space copy once the object has been evacuated
+} SpaceObject;
+
+// The copying heap, two halves of which only from_space holds objects between collections
+inline char *from_space = NULL;
+inline char *to_space = NULL;
+inline char *space_top = NULL;
+inline Graph *space_graph = NULL;
+inline const int *space_roots = NULL;
+inline int space_num_roots = 0;
+inline size_t space_collections = 0;
+inline size_t space_bytes_copied = 0;
+inline double space_max_pause = 0.0;
+inline char *space_slot_done = NULL; // vertex slots already evacuated by the current collection
+inline int space_slot_capacity = 0;
+inline Node **space_pinned = NULL; // scan stack of reachable nodes outside the copying heap
+inline int space_pinned_count = 0;
+inline int space_pinned_capacity = 0;
+
+// Function to map both halves of the copying heap, dropping the ones mapped before
+inline void init_semispace() {
+    if (from_space)
+        munmap(from_space < to_space ? from_space : to_space, 2 * (size_t)SEMISPACE_SIZE);
+    char *space = (char *)mmap(NULL, 2 * (size_t)SEMISPACE_SIZE, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (space == MAP_FAILED) {
+        fprintf(stderr, "Error: Unable to initialize semispace\n");
+        exit(1);
+    }
+    from_space = space;
+    to_space = space + SEMISPACE_SIZE;
+    space_top = from_space;
+}
+
+// Function to register the graph and root vertices the copying collector traces from
+inline void semispace_set_roots(Graph* graph, const int* rootVertices, int numRoots) {
+    space_graph = graph;
+    space_roots = rootVertices;
+    space_num_roots = numRoots;
+}
+
+inline int in_from_space(void *ptr) {
+    return (char *)ptr >= from_space && (char *)ptr < from_space + SEMISPACE_SIZE;
+}
+
+// Function to evacuate one node to to-space, returning its new address. A node outside the
+// copying heap, one allocated from the block heap under another policy, does not move but is
+// queued so its successor and the list of the vertex it points to are traced as well. Every node
+// has a single referrer, so each is queued at most once
+inline Node* evacuate(Node* node) {
+    if (node == NULL)
+        return node;
+    if (!in_from_space(node)) {
+        if (space_pinned_count == space_pinned_capacity) {
+            space_pinned_capacity = space_pinned_capacity ? space_pinned_capacity * 2 : 64;
+            space_pinned = (Node **)realloc(space_pinned, space_pinned_capacity * sizeof(Node *));
+        }
+        space_pinned[space_pinned_count++] = node;
+        return node;
+    }
+    SpaceObject *obj = (SpaceObject *)node - 1;
+    if (obj->forward == NULL) {
+        SpaceObject *copy = (SpaceObject *)space_top;
+        memcpy(copy, obj, sizeof(SpaceObject) + obj->size);
+        space_top += sizeof(SpaceObject) + obj->size;
+        obj->forward = copy + 1;
+        copy->forward = NULL;
+    }
+    return (Node *)obj->forward;
+}
+
+// Function to evacuate the list of vertex 'v' the first time the collection reaches it
+inline void evacuate_slot(Graph* graph, int v) {
+    if (space_slot_done[v])
+        return;
+    space_slot_done[v] = 1;
+    graph->array[v] = evacuate(graph->array[v]);
+}
+
+// Function to perform Cheney copying garbage collection: the lists of the root vertices are
+// copied to to-space, which is then scanned breadth first, each scanned node evacuating its
+// successor and the list of the vertex it points to. Nodes outside the copying heap stay where
+// they are and are scanned the same way. Lists left in from-space are garbage, and an unreachable
+// list that starts outside the copying heap loses its tail in from-space.
+// Returns the number of vertices whose lists were reclaimed in whole or in part
+inline int semispace_collect(Graph* graph, const int* rootVertices, int numRoots) {
+    clock_t start = clock();
+    // Evacuating the roots is the root scan, Cheney's scan is the mark
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    if (space_slot_capacity < graph->numVertices) {
+        free(space_slot_done);
+        space_slot_capacity = graph->numVertices;
+        space_slot_done = (char *)malloc(space_slot_capacity);
+    }
+    memset(space_slot_done, 0, graph->numVertices);
+    space_pinned_count = 0;
+    space_top = to_space;
+    for (int r = 0; r < numRoots; r++)
+        evacuate_slot(graph, rootVertices[r]);
+
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    char *scan = to_space;
+    while (scan < space_top || space_pinned_count > 0) {
+        Node* node;
+        if (scan < space_top) {
+            SpaceObject *obj = (SpaceObject *)scan;
+            node = (Node *)(obj + 1);
+            scan += sizeof(SpaceObject) + obj->size;
+            GC_STATS_VISIT(1, sizeof(SpaceObject) + obj->size);
+        } else {
+            node = space_pinned[--space_pinned_count];
+            GC_STATS_VISIT(1, sizeof(Node));
+        }
+        node->next = evacuate(node->next);
+        evacuate_slot(graph, node->data);
+    }
+
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+    int reclaimed = 0;
+    for (int i = 0; i < graph->numVertices; i++) {
+        if (in_from_space(graph->array[i])) {
+            graph->array[i] = NULL;
+            reclaimed++;
+        } else if (!space_slot_done[i]) {
+            // An unreachable list that starts outside the copying heap may still end in
+            // from-space, cut it there so no pointer into the old space survives the flip
+            for (Node* current = graph->array[i]; current; current = current->next) {
+                if (in_from_space(current->next)) {
+                    current->next = NULL;
+                    reclaimed++;
+                    break;
+                }
+            }
+        }
+    }
+    char *old_space = from_space;
+    from_space = to_space;
+    to_space = old_space;
+
+    double pause = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (pause > space_max_pause)
+        space_max_pause = pause;
+    space_bytes_copied += space_top - from_space;
+    space_collections++;
+    GC_STATS_END_COLLECTION(0);
+    return reclaimed;
+}
+
+// Function to bump allocate 'size' bytes in the copying heap, collecting once when it is full
+inline void *semispace_alloc(size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    if (space_top + sizeof(SpaceObject) + size > from_space + SEMISPACE_SIZE) {
+        if (space_graph == NULL)
+            return NULL;
+        semispace_collect(space_graph, space_roots, space_num_roots);
+        if (space_top + sizeof(SpaceObject) + size > from_space + SEMISPACE_SIZE)
+            return NULL;
+    }
+    SpaceObject *obj = (SpaceObject *)space_top;
+    obj->size = size;
+    obj->forward = NULL;
+    space_top += sizeof(SpaceObject) + size;
+    return obj + 1;
+}
+
+// The nursery, young nodes are bump allocated here and promoted to the block heap on a minor GC
+inline char *nursery = NULL;
+inline char *nursery_top = NULL;
+inline Node **promoted = NULL; // scan queue of the nodes promoted by the current minor GC
+inline Graph *gen_graph = NULL;
+inline const int *gen_roots = NULL;
+inline int gen_num_roots = 0;
+inline char *old_referenced = NULL; // vertices pointed at by at least one old node
+inline char *remembered = NULL;
+inline int *remembered_set = NULL; // vertex slots holding young lists that old nodes point at
+inline int remembered_count = 0;
+inline Node **remembered_nodes = NULL; // old nodes whose next field was set to a young node
+inline int remembered_node_count = 0;
+inline int remembered_node_capacity = 0;
+inline size_t minor_collections = 0;
+inline size_t promoted_bytes = 0;
+inline double minor_max_pause = 0.0;
+
+// Function to rebuild the vertices old nodes point at from a full scan of the graph
+inline void scan_old_references(Graph* graph) {
+    memset(old_referenced, 0, graph->numVertices);
+    for (int i = 0; i < graph->numVertices; i++)
+        for (Node* current = graph->array[i]; current; current = current->next)
+            old_referenced[current->data] = 1;
+}
+
+// Function to map the nursery and set up the remembered set for 'graph'. Every node the graph
+// already holds is old, so the vertices they point at are seeded before the first young store
+inline void init_generations(Graph* graph, const int* rootVertices, int numRoots) {
+    nursery = (char *)mmap(NULL, NURSERY_SIZE, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (nursery == MAP_FAILED) {
+        fprintf(stderr, "Error: Unable to initialize nursery\n");
+        exit(1);
+    }
+    nursery_top = nursery;
+    promoted = (Node **)malloc((NURSERY_SIZE / sizeof(Node)) * sizeof(Node *));
+    gen_graph = graph;
+    gen_roots = rootVertices;
+    gen_num_roots = numRoots;
+    old_referenced = (char *)calloc(graph->numVertices, sizeof(char));
+    remembered = (char *)calloc(graph->numVertices, sizeof(char));
+    remembered_set = (int *)malloc(graph->numVertices * sizeof(int));
+    remembered_count = 0;
+    remembered_node_count = 0;
+    scan_old_references(graph);
+}
+
+inline int in_nursery(void *ptr) {
+    return (char *)ptr >= nursery && (char *)ptr < nursery + NURSERY_SIZE;
+}
+
+// Write barrier for stores into the vertex array: a young list head in a slot that old nodes
+// point at is an old-to-young reference, so the slot is remembered for the next minor GC
+inline void write_barrier(Graph* graph, int vertex) {
+    if (old_referenced[vertex] && !remembered[vertex] && in_nursery(graph->array[vertex])) {
+        remembered[vertex] = 1;
+        remembered_set[remembered_count++] = vertex;
+    }
+}
+
+// Function to store 'value' in the slot of 'vertex'; the mutator writes slots only through here
+// so the generational mode sees every store
+inline void write_slot(Graph* graph, int vertex, Node* value) {
+    graph->array[vertex] = value;
+    if (alloc_mode == ALLOC_GENERATIONAL)
+        write_barrier(graph, vertex);
+}
+
+// Function to store 'value' in the next field of 'node'. In the generational mode an old node
+// that now points at a young one is remembered, and the next minor GC promotes its successor
+inline void write_next(Node* node, Node* value) {
+    node->next = value;
+    if (alloc_mode != ALLOC_GENERATIONAL || in_nursery(node) || !in_nursery(value))
+        return;
+    if (remembered_node_count == remembered_node_capacity) {
+        remembered_node_capacity = remembered_node_capacity ? remembered_node_capacity * 2 : 64;
+        remembered_nodes = (Node **)realloc(remembered_nodes, remembered_node_capacity * sizeof(Node *));
+    }
+    remembered_nodes[remembered_node_count++] = node;
+}
+
+// Function to copy one young node into the block heap, returning its old-generation address.
+// The nursery copy is overwritten with a forwarding pointer, data -1 and next the old copy, so
+// a node reached again through another referrer is not promoted twice
+inline Node* promote(Node* node, int* count) {
+    if (node == NULL || !in_nursery(node))
+        return node;
+    if (node->data < 0)
+        return node->next;
+    Node* old = (Node*)alloc_first_fit(sizeof(Node));
+    if (old == NULL) {
+        fprintf(stderr, "Error: Heap exhausted\n");
+        exit(1);
+    }
+    *old = *node;
+    node->data = -1;
+    node->next = old;
+    promoted[(*count)++] = old;
+    promoted_bytes += sizeof(Node);
+    return old;
+}
+
+// Function to perform a minor collection: young lists reachable from the root vertices, the
+// remembered slots and the remembered old nodes are promoted to the block heap, scanning promoted nodes like Cheney's
+// algorithm. Young list prefixes left behind are dead and the nursery is reset. Returns the
+// number of young nodes that died
+inline int minor_collect(Graph* graph, const int* rootVertices, int numRoots) {
+    clock_t start = clock();
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    int count = 0;
+    for (int r = 0; r < numRoots; r++)
+        graph->array[rootVertices[r]] = promote(graph->array[rootVertices[r]], &count);
+    for (int i = 0; i < remembered_count; i++) {
+        int v = remembered_set[i];
+        graph->array[v] = promote(graph->array[v], &count);
+        remembered[v] = 0;
+    }
+    remembered_count = 0;
+    for (int i = 0; i < remembered_node_count; i++)
+        remembered_nodes[i]->next = promote(remembered_nodes[i]->next, &count);
+    remembered_node_count = 0;
+
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    for (int scan = 0; scan < count; scan++) {
+        Node* node = promoted[scan];
+        node->next = promote(node->next, &count);
+        old_referenced[node->data] = 1;
+        graph->array[node->data] = promote(graph->array[node->data], &count);
+    }
+
+    // Old nodes no longer point into the nursery, so an unpromoted list keeps only its suffix
+    // from the first old or forwarded node on
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+    for (int i = 0; i < graph->numVertices; i++) {
+        Node* current = graph->array[i];
+        while (in_nursery(current))
+            current = current->next;
+        graph->array[i] = current;
+    }
+    int died = (int)((nursery_top - nursery) / sizeof(Node)) - count;
+    nursery_top = nursery;
+    GC_STATS_VISIT(count, count * sizeof(Node));
+    GC_STATS_FREE(died, died * sizeof(Node));
+    GC_STATS_END_COLLECTION(free_block_count());
+
+    double pause = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (pause > minor_max_pause)
+        minor_max_pause = pause;
+    minor_collections++;
+    return died;
+}
+
+// Function to bump allocate 'size' bytes in the nursery, running a minor GC when it is full
+inline void *nursery_alloc(size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    if (nursery_top + size > nursery + NURSERY_SIZE) {
+        minor_collect(gen_graph, gen_roots, gen_num_roots);
+        if (nursery_top + size > nursery + NURSERY_SIZE)
+            return NULL;
+    }
+    void *ptr = nursery_top;
+    nursery_top += size;
+    return ptr;
+}
+
+// Function to create a new node
+inline Node* createNode(int data) {
+    Node* newNode;
+    if (alloc_mode == ALLOC_GENERATIONAL)
+        newNode = (Node*)nursery_alloc(sizeof(Node));
+    else if (alloc_mode == ALLOC_SEMISPACE)
+        newNode = (Node*)semispace_alloc(sizeof(Node));
+    else
+        newNode = (Node*)alloc(sizeof(Node));
+    if (newNode == NULL) {
+        fprintf(stderr, "Error: Heap exhausted\n");
+        exit(1);
+    }
+    newNode->data = data;
+    newNode->next = NULL;
+    return newNode;
+}
+
+// Function to create a graph with 'numVertices' vertices
+inline Graph* createGraph(int numVertices) {
+    Graph* graph = (Graph*)alloc(sizeof(Graph));
+    graph->numVertices = numVertices;
+    graph->array = (Node**)alloc(numVertices * sizeof(Node*));
+    for (int i = 0; i < numVertices; ++i)
+        graph->array[i] = NULL;
+    return graph;
+}
+
+// Function to add an edge to an undirected graph
+inline void addEdge(Graph* graph, int src, int dest) {
+    Node* newNode = createNode(dest);
+    write_next(newNode, graph->array[src]);
+    write_slot(graph, src, newNode);
+}
+
+// Reusable bitmap the lazy sweep keeps reading after its pause, grown when the graph outgrows it
+inline MarkBitmap* lazy_marks = NULL;
+
+// Function to mark every vertex reachable from the root vertices
+inline void mark_roots(Graph* graph, const int* rootVertices, int numRoots, MarkBitmap* marks) {
+    for (int r = 0; r < numRoots; r++) {
+        if (!is_marked(marks, rootVertices[r]))
+            DFS_iterative(graph, rootVertices[r], marks);
+    }
+}
+
+// Structure to count collection pauses by power-of-two duration
+typedef struct {
+    long counts[PAUSE_BUCKETS];
+} PauseHistogram;
+
+inline PauseHistogram eager_pauses;
+inline PauseHistogram lazy_pauses;
+
+// Function to add one pause of 'seconds' to a histogram
+inline void record_pause(PauseHistogram* hist, double seconds) {
+    double us = seconds * 1e6;
+    int b = 0;
+    while (b < PAUSE_BUCKETS - 1 && us >= (double)(1L << b))
+        b++;
+    hist->counts[b]++;
+}
+
+// Function to print the non-empty buckets of a pause histogram
+inline void print_pause_histogram(const char* name, const PauseHistogram* hist) {
+    printf("%s pauses:\n", name);
+    for (int b = 0; b < PAUSE_BUCKETS; b++) {
+        if (hist->counts[b])
+            printf("  < %ld us : %ld\n", 1L << b, hist->counts[b]);
+    }
+}
+
+// Function to perform mark and sweep garbage collection from the root vertices
+inline void finish_lazy_sweep();
+
+inline void mark_and_sweep(Graph* graph, const int* rootVertices, int numRoots) {
+    finish_lazy_sweep();
+    clock_t start = clock();
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    // Clear the side mark bitmap
+    MarkBitmap* marks = collector_bitmap(graph->numVertices);
+
+    // Mark all reachable nodes starting from the roots
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    mark_roots(graph, rootVertices, numRoots, marks);
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+	//the output of the mark and sweep may vary from one another depending on the starting vertex of the graph
+    if (!quiet && gc_report_verbose())
+        printf("\nGarbage nodes:\n");
+    int sum = 0;
+    // Garbage blocks are freed in one batch at the end of the sweep
+    int count = 0, capacity = 16;
+    void **garbage = (void **)malloc(capacity * sizeof(void *));
+    // Walk the garbage by finding zero bits in the bitmap
+    for (int i = next_unmarked(marks, 0); i >= 0; i = next_unmarked(marks, i + 1)) {
+        if (graph->array[i] == NULL)
+            continue; // nothing left to reclaim, e.g. a list a minor GC already dropped
+        // Roots are marked, so only the garbage is left
+        if (!quiet && gc_report_object("garbage", i, sizeof(Node)))
+            printf("Node value = %d, Memory freed = %d\n", i, (int)sizeof(Node));
+        Node* current = graph->array[i];
+        while (current) {
+            if (count == capacity) {
+                capacity *= 2;
+                garbage = (void **)realloc(garbage, capacity * sizeof(void *));
+            }
+            garbage[count++] = (void *)current;
+            if (!quiet && gc_report_object("freed", current->data, sizeof(Node)))
+                printf("Node %d freed.\n", current->data);
+            GC_STATS_FREE(1, sizeof(Node));
+            current = current->next;
+        }
+        graph->array[i] = NULL;
+        sum += sizeof(Node);
+    }
+    GC_STATS_PHASE(GC_PHASE_COALESCE);
+    free_mem_many(garbage, count);
+    free(garbage);
+    GC_STATS_END_COLLECTION(free_block_count());
+    if (!quiet)
+        printf("Total memory freed = %d\n", sum);
+    record_pause(&eager_pauses, (double)(clock() - start) / CLOCKS_PER_SEC);
+}
+
+// State of a collection whose sweep is still pending, its marks are in lazy_marks
+inline Graph* lazy_graph = NULL;
+inline int lazy_cursor = -1;
+inline long lazy_swept = 0;
+
+// Function to sweep the next few unmarked vertices of a pending lazy collection, called by alloc()
+// through heap_reclaim_step when no free block fits, never from inside a collection or under
+// heap_lock. Returns 0 once there is nothing left to sweep
+inline int lazy_sweep_step() {
+    if (lazy_cursor < 0)
+        return 0;
+    size_t budget = LAZY_SWEEP_PAGES * (size_t)sysconf(_SC_PAGESIZE);
+    size_t freed = 0;
+    // Each step's time counts towards the sweep of the collection that left the garbage, unless
+    // some other phase is already being timed
+    bool timed = GC_STATS_PHASE_IF_IDLE(GC_PHASE_SWEEP);
+    while (freed < budget) {
+        int i = next_unmarked(lazy_marks, lazy_cursor);
+        if (i < 0) {
+            lazy_cursor = -1;
+            break;
+        }
+        lazy_cursor = i + 1;
+        Node* current = lazy_graph->array[i];
+        lazy_graph->array[i] = NULL;
+        while (current) {
+            Node* next = current->next;
+            Block *block = (Block *)current - 1;
+            freed += sizeof(Block) + block->size;
+            GC_STATS_FREE(1, block->size);
+            if (release_block(block))
+                coalesce(block);
+            lazy_swept++;
+            current = next;
+        }
+    }
+    if (timed)
+        GC_STATS_END_PHASE();
+    return 1;
+}
+
+// Function to sweep whatever a lazy collection has left
+inline void finish_lazy_sweep() {
+    while (lazy_sweep_step())
+        ;
+}
+
+// Function to perform mark and sweep garbage collection with a lazy sweep: the pause only marks
+// from the root vertices, and the unmarked lists are reclaimed a few pages at a time by alloc().
+// Like any garbage, a vertex found unreachable must not be linked to again before the sweep
+// reaches it. The marks live in their own bitmap, so other collections may run in between
+inline void mark_and_sweep_lazy(Graph* graph, const int* rootVertices, int numRoots) {
+    finish_lazy_sweep();
+    clock_t start = clock();
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    MarkBitmap* marks = reuse_bitmap(&lazy_marks, graph->numVertices);
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    mark_roots(graph, rootVertices, numRoots, marks);
+    lazy_graph = graph;
+    lazy_cursor = 0;
+    heap_reclaim_step = lazy_sweep_step;
+    GC_STATS_END_COLLECTION(free_block_count());
+    record_pause(&lazy_pauses, (double)(clock() - start) / CLOCKS_PER_SEC);
+}
+
+// Function to perform a full collection: the nursery is emptied by a minor GC, then the old
+// generation is marked and swept and the old-to-young bookkeeping is rebuilt from what survived
+inline void full_collect(Graph* graph) {
+    minor_collect(graph, gen_roots, gen_num_roots);
+    mark_and_sweep(graph, gen_roots, gen_num_roots);
+    scan_old_references(graph);
+}
+
+// Function to return every block parked on a size-class list to the general pool
+inline void flush_class_lists() {
+    for (int c = 0; c < NUM_SIZE_CLASSES; c++) {
+        for (Block *block = class_free_lists[c]; block; block = *(Block **)(block + 1)) {
+            block->size_class = -1;
+            block->chunk->free_bytes += block->size;
+        }
+        class_free_lists[c] = NULL;
+        class_free_counts[c] = 0;
+    }
+    fit_chunk = chunk_list;
+}
+
+// Function to translate a payload pointer to where its block will live after compaction; blocks
+// that do not move keep their address
+inline void *forwarded(void *ptr) {
+    if (ptr == NULL || ((Block *)ptr - 1)->forward == NULL)
+        return ptr;
+    return (void *)(((Block *)ptr - 1)->forward + 1);
+}
+
+// Function to let compaction move the block holding 'ptr'
+inline void set_movable(void *ptr) {
+    if (ptr)
+        ((Block *)ptr - 1)->forward = (Block *)ptr - 1;
+}
+
+// Function to perform Lisp-2 style mark-compact garbage collection. Live vertices are marked
+// from 'rootVertices', forwarding addresses are computed, every reference in the graph and in
+// 'refs' is rewritten, and the live blocks slide down towards the start of their chunk. Only the
+// graph, its vertex array and the lists of marked vertices move, since those are the only
+// references compaction can rewrite: any other allocated block (one a caller or a thread cache
+// holds, or another graph's) is pinned where it is and the free space around it stays behind as
+// free blocks
+inline void mark_compact(Graph** graphp, const int* rootVertices, int numRoots, Node** refs, int numRefs) {
+    // A pending lazy sweep would free lists by their old addresses
+    finish_lazy_sweep();
+    Graph* graph = *graphp;
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    MarkBitmap* marks = collector_bitmap(graph->numVertices);
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    mark_roots(graph, rootVertices, numRoots, marks);
+
+    // Garbage lists are simply dropped, compaction reclaims their blocks
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+    int garbage = 0;
+    flush_class_lists();
+    for (int i = next_unmarked(marks, 0); i >= 0; i = next_unmarked(marks, i + 1)) {
+        for (Node* current = graph->array[i]; current; current = current->next) {
+            Block *block = (Block *)current - 1;
+            block->free = 1;
+            block->size_class = -1;
+            block->chunk->free_bytes += block->size;
+            garbage++;
+            GC_STATS_FREE(1, block->size);
+        }
+        graph->array[i] = NULL;
+    }
+    for (int r = 0; r < numRefs; r++) {
+        if (refs[r] && ((Block *)refs[r] - 1)->free)
+            refs[r] = NULL;
+    }
+    double fragmentation_before = heap_fragmentation();
+    clock_t start = clock();
+    // Sliding the live blocks together is what coalesces the free space
+    GC_STATS_PHASE(GC_PHASE_COALESCE);
+
+    // Pick the blocks that may move: every other allocated block is pinned
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        for (Block *block = chunk->first; block; block = block->next)
+            block->forward = NULL;
+    }
+    set_movable(graph);
+    set_movable(graph->array);
+    for (int i = 0; i < graph->numVertices; i++) {
+        for (Node* current = graph->array[i]; current; current = current->next)
+            set_movable(current);
+    }
+
+    // Compute forwarding addresses: movable blocks are packed from the start of their chunk or
+    // from the end of the last pinned block before them
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        char *dest = (char *)chunk->first;
+        for (Block *block = chunk->first; block; block = block->next) {
+            if (block->free)
+                continue;
+            if (block->forward) {
+                block->forward = (Block *)dest;
+                dest += sizeof(Block) + block->size;
+            } else {
+                dest = (char *)(block + 1) + block->size;
+            }
+        }
+    }
+
+    // Update references while every object is still at its old address
+    for (int i = 0; i < graph->numVertices; i++) {
+        Node* current = graph->array[i];
+        while (current) {
+            Node* next = current->next;
+            current->next = (Node *)forwarded(next);
+            current = next;
+        }
+        graph->array[i] = (Node *)forwarded(graph->array[i]);
+    }
+    graph->array = (Node **)forwarded(graph->array);
+    *graphp = (Graph *)forwarded(graph);
+    for (int r = 0; r < numRefs; r++)
+        refs[r] = (Node *)forwarded(refs[r]);
+
+    // Slide the movable blocks down and rebuild each chunk's block list behind them. The space a
+    // run of garbage leaves before a pinned block is a whole number of blocks, so it is either
+    // empty or large enough for a free block header
+    size_t moved = 0;
+    for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next) {
+        Block *last = NULL;
+        Block *first_free = NULL;
+        char *top = (char *)chunk->first;
+        chunk->free_bytes = 0;
+        Block *block = chunk->first;
+        while (block) {
+            Block *next = block->next;
+            if (!block->free) {
+                Block *dest = block->forward ? block->forward : block;
+                if (dest != block) {
+                    memmove(dest, block, sizeof(Block) + block->size);
+                    moved += sizeof(Block) + block->size;
+                } else if ((size_t)((char *)block - top) >= sizeof(Block)) {
+                    // A pinned block: the gap below it becomes a free block
+                    Block *free_block = (Block *)top;
+                    free_block->size = (char *)block - top - sizeof(Block);
+                    free_block->free = 1;
+                    free_block->size_class = -1;
+                    free_block->chunk = chunk;
+                    free_block->prev = last;
+                    if (last)
+                        last->next = free_block;
+                    else
+                        chunk->first = free_block;
+                    last = free_block;
+                    if (first_free == NULL)
+                        first_free = free_block;
+                    chunk->free_bytes += free_block->size;
+                }
+                dest->forward = NULL;
+                dest->prev = last;
+                dest->next = NULL;
+                if (last)
+                    last->next = dest;
+                else
+                    chunk->first = dest;
+                last = dest;
+                top = (char *)(dest + 1) + dest->size;
+            }
+            block = next;
+        }
+        size_t rest = (char *)chunk + chunk->size - top;
+        if (rest >= sizeof(Block)) {
+            Block *free_block = (Block *)top;
+            free_block->size = rest - sizeof(Block);
+            free_block->free = 1;
+            free_block->size_class = -1;
+            free_block->chunk = chunk;
+            free_block->next = NULL;
+            free_block->prev = last;
+            if (last)
+                last->next = free_block;
+            else
+                chunk->first = free_block;
+            if (first_free == NULL)
+                first_free = free_block;
+            chunk->free_bytes += free_block->size;
+        } else {
+            last->size += rest; // too small for a header, the last live block absorbs it
+        }
+        chunk->first_free = first_free;
+    }
+    fit_chunk = chunk_list;
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    release_free_chunks();
+    GC_STATS_END_COLLECTION(free_block_count());
+
+    if (quiet)
+        return;
+    printf("Garbage nodes reclaimed by compaction = %d\n", garbage);
+    printf("Fragmentation before = %.3f, after = %.3f\n", fragmentation_before, heap_fragmentation());
+    printf("Compacted %zu bytes at %.1f MB/s\n", moved,
+           seconds > 0 ? moved / seconds / (1024.0 * 1024.0) : 0.0);
+}
+
+// Function to mark from every root of a replayed trace and free the allocated objects left
+// unmarked, with their memory and outgoing edges; returns the number of objects freed
+inline int replay_collect(Graph* graph, MarkBitmap* roots, MarkBitmap* allocated, void** payload, uint32_t* fields) {
+    GC_STATS_BEGIN_COLLECTION();
+    GC_STATS_PHASE(GC_PHASE_ROOTS);
+    MarkBitmap* marks = collector_bitmap(graph->numVertices);
+    GC_STATS_PHASE(GC_PHASE_MARK);
+    for (int w = 0; w < roots->numWords; w++) {
+        for (uint64_t bits = roots->words[w]; bits; bits &= bits - 1) {
+            int root = w * 64 + __builtin_ctzll(bits);
+            if (!is_marked(marks, root))
+                DFS_iterative(graph, root, marks);
+        }
+    }
+    GC_STATS_PHASE(GC_PHASE_SWEEP);
+    int freed = 0;
+    for (int w = 0; w < allocated->numWords; w++) {
+        uint64_t garbage = allocated->words[w] & ~marks->words[w];
+        allocated->words[w] &= ~garbage;
+        for (; garbage; garbage &= garbage - 1) {
+            int i = w * 64 + __builtin_ctzll(garbage);
+            Node* current = graph->array[i];
+            graph->array[i] = NULL;
+            while (current) {
+                Node* next = current->next;
+                GC_STATS_FREE(0, sizeof(Node));
+                free_mem(current);
+                current = next;
+            }
+            if (payload[i])
+                GC_STATS_FREE(1, ((Block *)payload[i] - 1)->size);
+            free_mem(payload[i]);
+            payload[i] = NULL;
+            memset(&fields[(size_t)i * TRACE_MAX_SLOTS], 0xFF, TRACE_MAX_SLOTS * sizeof(uint32_t));
+            freed++;
+        }
+    }
+    GC_STATS_END_COLLECTION(free_block_count());
+    return freed;
+}
+
+// Structure to represent the outcome of replaying a trace
+typedef struct {
+    double seconds;
+    int collections;
+    size_t mapped; // bytes of heap mapped at the end
+    long collected; // objects the collections freed
+    long live_objects; // objects still allocated at the end
+} ReplayResult;
+
+// Function to replay a mapped heap trace on a heap set up with init_heap(). "alloc" mode forwards
+// allocations and explicit frees to alloc()/free_mem(); "marksweep" mode records stores as edges,
+// takes explicit frees as hints and marks and sweeps from the trace's roots after every
+// REPLAY_GC_BYTES of allocation, before an id still live is allocated again and at the end. Every
+// event is checked as it is read. The objects left are freed before returning, and the allocation
+// policy is restored. Returns 0 on success
+inline int replay_events(const TraceMap* trace, const char* mode, ReplayResult* result) {
+    int collecting = strcmp(mode, "marksweep") == 0;
+    if (!collecting && strcmp(mode, "alloc") != 0) {
+        fprintf(stderr, "Error: Unknown replay mode %s\n", mode);
+        return 1;
+    }
+    // Size classes keep allocation O(1) however many objects the trace keeps live
+    int was_mode = alloc_mode;
+    set_alloc_mode(ALLOC_SEGREGATED);
+    int was_quiet = quiet;
+    quiet = 1;
+    int n = (int)trace->header->num_objects;
+    void** payload = (void**)calloc(n, sizeof(void*));
+    MarkBitmap* roots = createMarkBitmap(n);
+    MarkBitmap* allocated = createMarkBitmap(n);
+    uint32_t* fields = (uint32_t*)malloc((size_t)n * TRACE_MAX_SLOTS * sizeof(uint32_t));
+    memset(fields, 0xFF, (size_t)n * TRACE_MAX_SLOTS * sizeof(uint32_t));
+    Graph* graph = createGraph(n);
+    size_t since_collection = 0;
+    int collections = 0;
+    long collected = 0;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t num_events = trace->header->num_events;
+    int status = 0;
+    for (uint64_t e = 0; e < num_events && status == 0; e++) {
+        const TraceEvent* ev = &trace->events[e];
+        if (trace_check_event(trace->header, ev, e) != 0) {
+            status = 1;
+            break;
+        }
+        switch (ev->op) {
+        case TRACE_ALLOC:
+            if (collecting && payload[ev->obj]) {
+                // Let the collector decide whether the program's free of this id was right
+                collected += replay_collect(graph, roots, allocated, payload, fields);
+                collections++;
+            }
+            if (payload[ev->obj]) {
+                fprintf(stderr, "Error: Trace event %llu at offset %llu allocates object %u, which is still live\n",
+                        (unsigned long long)e, trace_event_offset(e), ev->obj);
+                status = 1;
+                break;
+            }
+            payload[ev->obj] = alloc(ev->arg);
+            set_mark(allocated, ev->obj);
+            since_collection += ev->arg;
+            if (collecting && since_collection > REPLAY_GC_BYTES) {
+                collected += replay_collect(graph, roots, allocated, payload, fields);
+                since_collection = 0;
+                collections++;
+            }
+            break;
+        case TRACE_FREE:
+            // An object the program frees is left to the collector, which finds it unreachable
+            if (!collecting) {
+                free_mem(payload[ev->obj]);
+                payload[ev->obj] = NULL;
+            }
+            break;
+        case TRACE_STORE: {
+            if (!collecting)
+                break;
+            uint32_t* field = &fields[(size_t)ev->obj * TRACE_MAX_SLOTS + ev->slot];
+            if (*field != TRACE_NULL) {
+                // Unlink one edge to the old target
+                Node* prev = NULL;
+                Node* temp = graph->array[ev->obj];
+                while (temp && (uint32_t)temp->data != *field) {
+                    prev = temp;
+                    temp = temp->next;
+                }
+                if (temp) {
+                    if (prev)
+                        write_next(prev, temp->next);
+                    else
+                        write_slot(graph, ev->obj, temp->next);
+                    free_mem(temp);
+                }
+            }
+            *field = ev->arg;
+            if (ev->arg != TRACE_NULL)
+                addEdge(graph, ev->obj, ev->arg);
+            break;
+        }
+        case TRACE_ROOT_ADD:
+            set_mark(roots, ev->obj);
+            break;
+        case TRACE_ROOT_REMOVE:
+            roots->words[ev->obj >> 6] &= ~((uint64_t)1 << (ev->obj & 63));
+            break;
+        }
+    }
+    if (status == 0 && collecting) {
+        collected += replay_collect(graph, roots, allocated, payload, fields);
+        collections++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (status == 0) {
+        result->seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        result->collections = collections;
+        result->mapped = 0;
+        for (Chunk *chunk = chunk_list; chunk; chunk = chunk->next)
+            result->mapped += chunk->size;
+        result->collected = collected;
+        result->live_objects = 0;
+        for (int i = 0; i < n; i++)
+            result->live_objects += payload[i] != NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        free_mem(payload[i]);
+        while (graph->array[i]) {
+            Node* next = graph->array[i]->next;
+            free_mem(graph->array[i]);
+            graph->array[i] = next;
+        }
+    }
+    free_mem(graph->array);
+    free_mem(graph);
+    free(payload);
+    free(fields);
+    freeMarkBitmap(roots);
+    freeMarkBitmap(allocated);
+    set_alloc_mode(was_mode);
+    quiet = was_quiet;
+    return status;
+}
+
+// Function to replay the heap trace at 'path' in one of replay_events()'s modes and print a
+// summary. Returns 0 on success
+inline int replay_trace(const char* path, const char* mode) {
+    TraceMap trace;
+    if (trace_map(path, &trace) != 0) {
+        fprintf(stderr, "Error: Unable to read trace %s\n", path);
+        return 1;
+    }
+    init_heap();
+    ReplayResult result;
+    int status = replay_events(&trace, mode, &result);
+    uint64_t num_events = trace.header->num_events;
+    trace_unmap(&trace);
+    if (status != 0)
+        return status;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("Replayed %llu events in %.3f s (%.1f M events/sec)\n", (unsigned long long)num_events,
+           result.seconds, result.seconds > 0 ? num_events / result.seconds / 1e6 : 0.0);
+    printf("Heap mapped = %zu bytes, peak RSS = %ld KB, collections = %d, objects collected = %ld\n",
+           result.mapped, usage.ru_maxrss, result.collections, result.collected);
+    return 0;
+}
+
+// Function to check that a trace freeing objects and allocating their ids again replays in both
+// modes, leaving the objects its program keeps
+inline bool replay_reuses_ids() {
+    const char* modes[] = {"alloc", "marksweep"};
+    char path[] = "/tmp/try2-trace-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0)
+        return false;
+    close(fd);
+    TraceMap trace;
+    bool mapped = trace_write_id_reuse(path) == 0 && trace_map(path, &trace) == 0;
+    bool ok = mapped;
+    unlink(path);
+    for (int m = 0; ok && m < 2; m++) {
+        ReplayResult result;
+        ok = replay_events(&trace, modes[m], &result) == 0 && result.live_objects == TRACE_REUSE_LIVE;
+    }
+    if (mapped)
+        trace_unmap(&trace);
+    return ok;
+}
+
+} // namespace blockms
+
+#endif